@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../src/CollisionGrid.h"
+#include "../src/Sprites.h"
+
+// Tests GAME_MAX_BULLETS bullets against formations of growing size, once
+// against every alien and once through the collision grid
+static const size_t NUM_BULLETS = GAME_MAX_BULLETS;
+
+// Laid out like AlienArray, but without its GAME_MAX_ALIENS limit
+struct Formation
+{
+	size_t columns, rows;
+	int16_t* x;
+	int16_t* y;
+	uint8_t* type;
+	size_t num_aliens;
+	size_t width, height;
+};
+
+struct BulletPositions
+{
+	int16_t x[NUM_BULLETS];
+	int16_t y[NUM_BULLETS];
+};
+
+static Formation CreateFormation(size_t columns, size_t rows)
+{
+	Formation f;
+	f.columns = columns;
+	f.rows = rows;
+	f.num_aliens = columns * rows;
+	f.x = new int16_t[f.num_aliens];
+	f.y = new int16_t[f.num_aliens];
+	f.type = new uint8_t[f.num_aliens];
+	for (size_t yi = 0; yi < rows; ++yi)
+	{
+		for (size_t xi = 0; xi < columns; ++xi)
+		{
+			size_t ai = yi * columns + xi;
+			f.type[ai] = (yi * 5 / rows) < 1 ? 3 : (yi * 5 / rows) < 3 ? 2 : 1;
+			f.x[ai] = 20 + xi * 17;
+			f.y[ai] = 128 + yi * 17;
+		}
+	}
+	f.width = 20 + columns * 17 + 20;
+	f.height = 128 + rows * 17 + 20;
+	return f;
+}
+
+static size_t brute_force(const Formation& f, const Sprite* alien_sprites, const Sprite& bullet_sprite, const BulletPositions& bullets)
+{
+	size_t hits = 0;
+	for (size_t bi = 0; bi < NUM_BULLETS; ++bi)
+	{
+		for (size_t ai = 0; ai < f.num_aliens; ++ai)
+		{
+			if (sprite_overlap_check(bullet_sprite, bullets.x[bi], bullets.y[bi],
+				alien_sprites[2 * (f.type[ai] - 1)], f.x[ai], f.y[ai]))
+			{
+				++hits;
+				break;
+			}
+		}
+	}
+	return hits;
+}
+
+static size_t with_grid(const Formation& f, const CollisionGrid& grid, const Sprite* alien_sprites, const Sprite& bullet_sprite, const BulletPositions& bullets)
+{
+	size_t hits = 0;
+	for (size_t bi = 0; bi < NUM_BULLETS; ++bi)
+	{
+		ptrdiff_t x = bullets.x[bi], y = bullets.y[bi];
+		size_t hit_alien = f.num_aliens;
+		collision_grid_visit(grid,
+			x, y, x + bullet_sprite.width, y + bullet_sprite.height,
+			[&](size_t ai)
+			{
+				if (ai < hit_alien && sprite_overlap_check(bullet_sprite, x, y,
+					alien_sprites[2 * (f.type[ai] - 1)], f.x[ai], f.y[ai]))
+				{
+					hit_alien = ai;
+				}
+			});
+		if (hit_alien < f.num_aliens) ++hits;
+	}
+	return hits;
+}
+
+template <typename F>
+static double time_ns(size_t iterations, F f)
+{
+	double best = 1e30;
+	for (int rep = 0; rep < 5; ++rep)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; ++i) f();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+	}
+	return best;
+}
+
+int main() {
+	const Sprite* alien_sprites = BUILTIN_SPRITES.alien_sprites;
+	const Sprite& bullet_sprite = BUILTIN_SPRITES.bullet_sprite;
+	srand(1);
+
+	const size_t sizes[][2] = { { 11, 5 }, { 22, 10 }, { 44, 20 } };
+	for (const auto& size : sizes)
+	{
+		Formation f = CreateFormation(size[0], size[1]);
+		CollisionGrid grid = CreateCollisionGrid(f.x, f.y, f.type, f.num_aliens, alien_sprites);
+
+		BulletPositions bullets;
+		for (size_t bi = 0; bi < NUM_BULLETS; ++bi)
+		{
+			bullets.x[bi] = rand() % f.width;
+			bullets.y[bi] = rand() % f.height;
+		}
+
+		size_t expected = brute_force(f, alien_sprites, bullet_sprite, bullets);
+		size_t got = with_grid(f, grid, alien_sprites, bullet_sprite, bullets);
+		if (expected != got)
+		{
+			fprintf(stderr, "Grid found %zu hits, brute force %zu\n", got, expected);
+			return 1;
+		}
+
+		volatile size_t sink = 0;
+		size_t iterations = 200000 / f.num_aliens + 10;
+		double brute_ns = time_ns(iterations, [&]() { sink = sink + brute_force(f, alien_sprites, bullet_sprite, bullets); });
+		double grid_ns = time_ns(iterations, [&]() { sink = sink + with_grid(f, grid, alien_sprites, bullet_sprite, bullets); });
+
+		printf("%4zu aliens x %zu bullets: brute force %9.0f ns/tick, grid %7.0f ns/tick, %.1fx\n",
+			f.num_aliens, NUM_BULLETS, brute_ns, grid_ns, brute_ns / grid_ns);
+
+		DestroyCollisionGrid(grid);
+		delete[] f.x;
+		delete[] f.y;
+		delete[] f.type;
+	}
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include "../src/Fill.h"
+
+// Compares the fill kernels on a full framebuffer clear at the native
+// 224x256 resolution and at 4x and 8x internal resolutions
+static double time_clear(FillKernel kernel, uint32_t* data, size_t count, size_t iterations)
+{
+	double best = 1e30;
+	for (int rep = 0; rep < 5; ++rep)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			kernel(data, count, static_cast<uint32_t>(i));
+		}
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::micro>(end - start).count() / iterations);
+	}
+	return best;
+}
+
+int main() {
+	struct { const char* name; FillKernel kernel; } kernels[] = {
+		{ "scalar", fill_u32_scalar },
+#ifdef FILL_HAS_X86_KERNELS
+		{ "sse2", fill_u32_sse2 },
+		{ "avx2", cpu_has_avx2() ? fill_u32_avx2 : NULL },
+#endif
+	};
+
+	printf("Selected kernel: %s\n", fill_kernel_name());
+	for (size_t scale = 1; scale <= 8; scale *= 2)
+	{
+		size_t count = 224 * scale * 256 * scale;
+		uint32_t* data = new uint32_t[count];
+		size_t iterations = std::max<size_t>(10, 20000 / (scale * scale));
+
+		double scalar_us = 0;
+		for (const auto& k : kernels)
+		{
+			if (!k.kernel) continue;
+			double us = time_clear(k.kernel, data, count, iterations);
+			if (k.kernel == fill_u32_scalar) scalar_us = us;
+			printf("clear %4zux%-4zu %-6s %9.2f us  %6.2f GB/s  %.2fx\n",
+				224 * scale, 256 * scale, k.name, us,
+				count * sizeof(uint32_t) / (us * 1e3), scalar_us / us);
+		}
+		delete[] data;
+	}
+
+	return 0;
+}
@@ -0,0 +1,496 @@
+#include <cstring>
+#include <benchmark/benchmark.h>
+#include "../src/Dirty.h"
+#include "../src/Render.h"
+#include "../src/Replay.h"
+#include "../src/Rewind.h"
+#include "../src/Simulation.h"
+#include "../src/SpriteBlob.h"
+#include "../src/Sprites.h"
+#include "../src/TileRaster.h"
+
+// Micro-benchmarks of the per-frame kernels. Sizes are the real game (55
+// aliens, up to GAME_MAX_BULLETS bullets, a 224x256 framebuffer) and
+// stress cases with the framebuffer scaled up to 8x and the formation
+// scaled with it. Run with --benchmark_format=json or --benchmark_out to
+// get machine-readable results
+static const GameSprites& sprites()
+{
+	return BUILTIN_SPRITES;
+}
+
+static Buffer CreateBuffer(size_t scale)
+{
+	Buffer buffer;
+	buffer.width = 224 * scale;
+	buffer.height = 256 * scale;
+	buffer.data = new uint32_t[buffer.width * buffer.height];
+	buffer.dirty = NULL;
+	buffer.draws = NULL;
+	return buffer;
+}
+
+static void BM_BufferClear(benchmark::State& state)
+{
+	Buffer buffer = CreateBuffer(state.range(0));
+	uint32_t color = 0;
+	for (auto _ : state)
+	{
+		buffer_clear(&buffer, ++color);
+		benchmark::DoNotOptimize(buffer.data);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * buffer.width * buffer.height * sizeof(uint32_t));
+	delete[] buffer.data;
+}
+BENCHMARK(BM_BufferClear)->Arg(1)->Arg(4)->Arg(8);
+
+// One alien sprite at every position of a row, so every shift of the
+// packed masks is covered
+static void BM_BufferDrawSprite(benchmark::State& state)
+{
+	Buffer buffer = CreateBuffer(1);
+	buffer_clear(&buffer, 0);
+	const Sprite& sprite = sprites().alien_sprites[4];
+	size_t x = 0;
+	for (auto _ : state)
+	{
+		buffer_draw_sprite(&buffer, sprite, x, 128, 0xFFFFFFFF);
+		benchmark::ClobberMemory();
+		if (++x + sprite.width > buffer.width) x = 0;
+	}
+	state.SetItemsProcessed(state.iterations());
+	delete[] buffer.data;
+}
+BENCHMARK(BM_BufferDrawSprite);
+
+// A whole frame of sprites: the formation, the player and a full set of
+// bullets. The formation has scale x scale times the 11x5 aliens, on a
+// framebuffer scaled the same way
+static void BM_DrawFrame(benchmark::State& state)
+{
+	size_t scale = state.range(0);
+	Buffer buffer = CreateBuffer(scale);
+	const GameSprites& game_sprites = sprites();
+	size_t columns = 11 * scale, rows = 5 * scale;
+
+	for (auto _ : state)
+	{
+		buffer_clear(&buffer, 0);
+		for (size_t yi = 0; yi < rows; ++yi)
+		{
+			const Sprite& sprite = game_sprites.alien_sprites[2 * (yi * 3 / rows)];
+			for (size_t xi = 0; xi < columns; ++xi)
+			{
+				buffer_draw_sprite(&buffer, sprite, 20 + xi * 17, 128 * scale + yi * 17, 0xFFFFFFFF);
+			}
+		}
+		for (size_t bi = 0; bi < GAME_MAX_BULLETS; ++bi)
+		{
+			buffer_draw_sprite(&buffer, game_sprites.bullet_sprite,
+				(bi * 37) % (buffer.width - 1), (bi * 53) % (buffer.height - 3), 0xFFFFFFFF);
+		}
+		buffer_draw_sprite(&buffer, game_sprites.player_sprite, buffer.width / 2, 32, 0xFFFFFFFF);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * (columns * rows + GAME_MAX_BULLETS + 1));
+	delete[] buffer.data;
+}
+BENCHMARK(BM_DrawFrame)->Arg(1)->Arg(2)->Arg(4);
+
+// The game's frame, recorded at 224x256 and drawn by the tiled
+// rasterizer at 4x or 8x on a pool of 1 to 4 threads
+static void BM_TiledFrame(benchmark::State& state)
+{
+	size_t scale = state.range(0);
+	const GameSprites& game_sprites = sprites();
+	Buffer buffer = CreateBuffer(1);
+	delete[] buffer.data;
+	buffer.data = NULL;
+	buffer.draws = new DrawList;
+
+	draw_list_clear(buffer.draws);
+	buffer_clear(&buffer, 0);
+	for (size_t yi = 0; yi < 5; ++yi)
+	{
+		const Sprite& sprite = game_sprites.alien_sprites[2 * (yi * 3 / 5)];
+		for (size_t xi = 0; xi < 11; ++xi)
+		{
+			buffer_draw_sprite(&buffer, sprite, 20 + xi * 17, 128 + yi * 17, 0xFFFFFFFF);
+		}
+	}
+	for (size_t bi = 0; bi < GAME_MAX_BULLETS; ++bi)
+	{
+		buffer_draw_sprite(&buffer, game_sprites.bullet_sprite,
+			(bi * 37) % (buffer.width - 1), (bi * 53) % (buffer.height - 3), 0xFFFFFFFF);
+	}
+	buffer_draw_sprite(&buffer, game_sprites.player_sprite, buffer.width / 2, 32, 0xFFFFFFFF);
+
+	ThreadPool* pool = CreateThreadPool(state.range(1));
+	TileRasterizer* rasterizer = CreateTileRasterizer(buffer.width, buffer.height, scale, pool);
+	uint32_t* target = new uint32_t[buffer.width * scale * buffer.height * scale];
+	for (auto _ : state)
+	{
+		tile_raster_draw(rasterizer, buffer.draws, target);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * buffer.width * scale * buffer.height * scale * sizeof(uint32_t));
+
+	delete[] target;
+	DestroyTileRasterizer(rasterizer);
+	DestroyThreadPool(pool);
+	delete buffer.draws;
+}
+BENCHMARK(BM_TiledFrame)->ArgNames({ "scale", "threads" })
+	->Args({ 4, 1 })->Args({ 4, 2 })->Args({ 4, 4 })
+	->Args({ 8, 1 })->Args({ 8, 2 })->Args({ 8, 4 })
+	->UseRealTime();
+
+// Draws the sprites of the game the way the simulation thread does
+static void draw_game(Buffer* buffer, const Simulation& sim)
+{
+	const Game& game = sim.game;
+	for (size_t ai = 0; ai < game.aliens.count; ++ai)
+	{
+		if (alien_alive(game.aliens, ai))
+		{
+			buffer_draw_sprite(buffer, sim.alien_sprite(game.aliens.type[ai]), game.aliens.x[ai] + game.xi / 2, game.aliens.y[ai] + game.yi, 0xFFFFFFFF);
+		}
+	}
+	for (size_t bi = 0; bi < game.bullets.count; ++bi)
+	{
+		buffer_draw_sprite(buffer, sprites().bullet_sprite, game.bullets.x[bi], game.bullets.y[bi], 0xFFFFFFFF);
+	}
+	buffer_draw_sprite(buffer, sprites().player_sprite, game.player.x, game.player.y, 0xFFFFFFFF);
+}
+
+// The GL thread copying a frame's pixels into the mapped pixel buffer
+// object: the whole frame, as after skipped frames, or the rectangles
+// that changed from one frame of a game in play to the next, two ticks
+// later. Rectangles are found at 224x256 and scaled like the game's
+static void BM_CopyRects(benchmark::State& state)
+{
+	size_t scale = state.range(0);
+	bool full_frame = state.range(1) != 0;
+	Buffer buffer = CreateBuffer(1);
+	buffer.dirty = CreateDirtyTracker();
+	Simulation sim(sprites(), 1);
+	for (size_t t = 0; t < 10 * SIMULATION_TICK_RATE; ++t)
+	{
+		sim.step(Input{ static_cast<int>(t / 60 % 3) - 1, t % 30 == 0 });
+		if (t + 2 < 10 * SIMULATION_TICK_RATE) continue;
+		dirty_begin_frame(buffer.dirty);
+		buffer_clear(&buffer, 0);
+		draw_game(&buffer, sim);
+		dirty_end_frame(buffer.dirty, buffer.width, buffer.height);
+	}
+
+	DirtyRect rects[DIRTY_MAX_RECTS];
+	size_t num_rects = buffer.dirty->num_rects;
+	for (size_t r = 0; r < num_rects; ++r)
+	{
+		const DirtyRect& rect = buffer.dirty->rects[r];
+		rects[r] = DirtyRect{ ptrdiff_t(rect.x * scale), ptrdiff_t(rect.y * scale), ptrdiff_t(rect.width * scale), ptrdiff_t(rect.height * scale) };
+	}
+	Buffer frame = CreateBuffer(scale);
+	if (full_frame)
+	{
+		rects[0] = DirtyRect{ 0, 0, ptrdiff_t(frame.width), ptrdiff_t(frame.height) };
+		num_rects = 1;
+	}
+	size_t pixels = 0;
+	for (size_t r = 0; r < num_rects; ++r) pixels += rects[r].width * rects[r].height;
+
+	buffer_clear(&frame, 0xFF00FF00);
+	uint32_t* mapped = new uint32_t[frame.width * frame.height];
+	for (auto _ : state)
+	{
+		buffer_copy_rects(&frame, mapped, rects, num_rects);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * pixels * sizeof(uint32_t));
+	state.counters["pixels"] = static_cast<double>(pixels);
+
+	delete[] mapped;
+	delete[] frame.data;
+	delete[] buffer.data;
+	delete buffer.dirty;
+}
+BENCHMARK(BM_CopyRects)->ArgNames({ "scale", "full_frame" })
+	->Args({ 1, 0 })->Args({ 1, 1 })
+	->Args({ 4, 0 })->Args({ 4, 1 })
+	->Args({ 8, 0 })->Args({ 8, 1 });
+
+// Every bullet against every alien of the formation, the way the game
+// checked hits before the batch test. Half the bullets are inside the
+// formation, so both the rectangle reject and the pixel test run
+static void BM_SpriteOverlapCheck(benchmark::State& state)
+{
+	size_t scale = state.range(0);
+	const GameSprites& game_sprites = sprites();
+	size_t columns = 11 * scale, rows = 5 * scale;
+	size_t width = 20 + columns * 17;
+
+	size_t bullet_x[GAME_MAX_BULLETS], bullet_y[GAME_MAX_BULLETS];
+	for (size_t bi = 0; bi < GAME_MAX_BULLETS; ++bi)
+	{
+		bullet_x[bi] = (bi * 37) % width;
+		bullet_y[bi] = bi % 2 ? 128 + (bi * 53) % (rows * 17) : (bi * 53) % 128;
+	}
+
+	for (auto _ : state)
+	{
+		size_t hits = 0;
+		for (size_t bi = 0; bi < GAME_MAX_BULLETS; ++bi)
+		{
+			for (size_t yi = 0; yi < rows; ++yi)
+			{
+				const Sprite& sprite = game_sprites.alien_sprites[2 * (yi * 3 / rows)];
+				for (size_t xi = 0; xi < columns; ++xi)
+				{
+					hits += sprite_overlap_check(game_sprites.bullet_sprite, bullet_x[bi], bullet_y[bi],
+						sprite, 20 + xi * 17, 128 + yi * 17);
+				}
+			}
+		}
+		benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.iterations() * GAME_MAX_BULLETS * columns * rows);
+}
+BENCHMARK(BM_SpriteOverlapCheck)->Arg(1)->Arg(2)->Arg(4);
+
+// The batch rectangle test the game uses instead, for the full formation
+static void BM_OverlapMask(benchmark::State& state)
+{
+	Simulation sim(sprites(), 1);
+	OverlapBatch batch = sim.alien_batch(0, 0);
+	for (auto _ : state)
+	{
+		uint64_t hits = 0;
+		for (size_t bi = 0; bi < GAME_MAX_BULLETS; ++bi)
+		{
+			hits |= overlap_mask(batch, (bi * 37) % 224, 128 + (bi * 53) % 85, 1, 3);
+		}
+		benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.iterations() * GAME_MAX_BULLETS * sim.game.aliens.count);
+}
+BENCHMARK(BM_OverlapMask);
+
+// Whole simulation ticks driven by the headless bot. The stress variant
+// keeps the bullet array full, spreading player bullets across the screen
+static void BM_SimulationTick(benchmark::State& state)
+{
+	bool full_bullets = state.range(0) != 0;
+	Simulation* sim = new Simulation(sprites(), 1);
+	// The bot's own generator, so its moves are the same on every run
+	Random bot = CreateRandom(1);
+	Input input = { 0, false };
+	size_t t = 0;
+
+	for (auto _ : state)
+	{
+		if (t % (SIMULATION_TICK_RATE / 2) == 0) input.move_dir = static_cast<int>(random_below(bot, 3)) - 1;
+		input.fire = (t % (SIMULATION_TICK_RATE / 4) == 0);
+		++t;
+
+		if (full_bullets)
+		{
+			BulletArray& bullets = sim->game.bullets;
+			while (bullets.count < GAME_MAX_BULLETS)
+			{
+				bullet_add(bullets, (bullets.count * 37) % 223, 8 + (bullets.count * 53) % 240, bullets.count % 8 == 0);
+			}
+		}
+
+		sim->step(input);
+
+		if (sim->game.gameOver)
+		{
+			state.PauseTiming();
+			delete sim;
+			sim = new Simulation(sprites(), 1);
+			state.ResumeTiming();
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	delete sim;
+}
+BENCHMARK(BM_SimulationTick)->ArgName("full_bullets")->Arg(0)->Arg(1);
+
+// Copying the whole state of a game, as a lookahead search or rollouts
+// would before playing on from it
+static void BM_GameClone(benchmark::State& state)
+{
+	Simulation sim(sprites(), 1);
+	for (size_t t = 0; t < 10 * SIMULATION_TICK_RATE; ++t)
+	{
+		Input input = { static_cast<int>(t / 60 % 3) - 1, t % 30 == 0 };
+		sim.step(input);
+	}
+
+	Game clones[64];
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		memcpy(&clones[i++ % 64], &sim.game, sizeof(Game));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * sizeof(Game));
+}
+BENCHMARK(BM_GameClone);
+
+// Jumping to around minute 40 of a 45 minute replay, by restoring the
+// keyframe before it or by simulating from tick zero
+static void BM_ReplaySeek(benchmark::State& state)
+{
+	bool keyframes = state.range(0) != 0;
+	const char* path = "kernelbench.replay";
+	const size_t ticks = 45 * 60 * SIMULATION_TICK_RATE;
+	{
+		Simulation sim(sprites(), 1);
+		ReplayRecorder* recorder = CreateReplayRecorder(path, 1);
+		for (size_t t = 0; t < ticks; ++t)
+		{
+			Input input = { static_cast<int>(t / 60 % 3) - 1, t % 30 == 0 };
+			replay_record(recorder, sim, input);
+			sim.step(input);
+		}
+		replay_recorder_finish(recorder, sim);
+		DestroyReplayRecorder(recorder);
+	}
+
+	Replay replay;
+	if (!LoadReplay(path, &replay))
+	{
+		state.SkipWithError("Could not load the replay");
+		return;
+	}
+
+	Simulation* sim = new Simulation(sprites(), 1);
+	size_t target = 40 * 60 * SIMULATION_TICK_RATE;
+	for (auto _ : state)
+	{
+		// Land anywhere between two keyframes
+		target += 97;
+		if (keyframes)
+		{
+			replay_seek(&replay, sim, target);
+		}
+		else
+		{
+			delete sim;
+			sim = new Simulation(sprites(), 1);
+			ReplayCursor cursor = replay_begin(&replay);
+			Input input;
+			while (sim->game.tick < target && replay_next(&cursor, &input)) sim->step(input);
+		}
+		benchmark::DoNotOptimize(sim->game.score);
+	}
+
+	delete sim;
+	DestroyReplay(&replay);
+	remove(path);
+}
+BENCHMARK(BM_ReplaySeek)->ArgName("keyframes")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Cost of recording every tick for rewinding, on top of stepping the
+// game, and the bytes of history each tick takes
+static void BM_RewindRecord(benchmark::State& state)
+{
+	bool record = state.range(0) != 0;
+	Simulation* sim = new Simulation(sprites(), 1);
+	RewindBuffer* rewind = CreateRewindBuffer(4 << 20);
+	size_t t = 0;
+
+	for (auto _ : state)
+	{
+		Input input = { static_cast<int>(t / 60 % 3) - 1, t % 30 == 0 };
+		++t;
+		if (record) rewind_record(rewind, *sim, input);
+		sim->step(input);
+
+		if (sim->game.gameOver)
+		{
+			state.PauseTiming();
+			delete sim;
+			sim = new Simulation(sprites(), static_cast<uint32_t>(t));
+			state.ResumeTiming();
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	if (record && rewind_ticks(rewind))
+	{
+		state.counters["bytes_per_tick"] = double(rewind->used) / rewind_ticks(rewind);
+	}
+	DestroyRewindBuffer(rewind);
+	delete sim;
+}
+BENCHMARK(BM_RewindRecord)->ArgName("record")->Arg(0)->Arg(1);
+
+// Stepping back one tick through 10 minutes of history
+static void BM_RewindStepBack(benchmark::State& state)
+{
+	Simulation* sim = new Simulation(sprites(), 1);
+	RewindBuffer* rewind = CreateRewindBuffer(4 << 20);
+	const size_t ticks = 10 * 60 * SIMULATION_TICK_RATE;
+
+	for (auto _ : state)
+	{
+		if (!rewind_step_back(rewind, sim))
+		{
+			state.PauseTiming();
+			for (size_t t = 0; t < ticks; ++t)
+			{
+				Input input = { static_cast<int>(t / 60 % 3) - 1, t % 30 == 0 };
+				rewind_record(rewind, *sim, input);
+				sim->step(input);
+			}
+			state.ResumeTiming();
+		}
+		benchmark::DoNotOptimize(sim->game.score);
+	}
+	state.SetItemsProcessed(state.iterations());
+	DestroyRewindBuffer(rewind);
+	delete sim;
+}
+BENCHMARK(BM_RewindStepBack);
+
+// Startup cost of the sprites: copying the tables built into the
+// executable, as Main does, or loading the blob atlaspacker writes
+static void BM_LoadSprites(benchmark::State& state)
+{
+	bool from_blob = state.range(0) != 0;
+	const char* path = "kernelbench_sprites.blob";
+	if (from_blob) write_sprite_blob(path, BUILTIN_SPRITES, BUILTIN_GLYPHS);
+
+	for (auto _ : state)
+	{
+		if (from_blob)
+		{
+			SpriteBlob blob;
+			if (!LoadSpriteBlob(path, &blob))
+			{
+				state.SkipWithError("Could not load the sprite blob");
+				break;
+			}
+			GameSprites sprites = sprite_blob_game_sprites(&blob);
+			GlyphAtlas glyphs = sprite_blob_glyphs(&blob);
+			benchmark::DoNotOptimize(sprites.player_sprite.rows);
+			benchmark::DoNotOptimize(glyphs.life_sprite.rows);
+			DestroySpriteBlob(&blob);
+		}
+		else
+		{
+			GameSprites sprites = BUILTIN_SPRITES;
+			GlyphAtlas glyphs = BUILTIN_GLYPHS;
+			benchmark::DoNotOptimize(sprites.player_sprite.rows);
+			benchmark::DoNotOptimize(glyphs.life_sprite.rows);
+		}
+	}
+	if (from_blob) remove(path);
+}
+BENCHMARK(BM_LoadSprites)->ArgName("blob")->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+
+// One SpriteInstance per quad
+layout(location = 0) in ivec4 rect;
+layout(location = 1) in uvec4 atlas_rect;
+layout(location = 2) in uint color;
+
+uniform vec2 screen_size;
+
+noperspective out vec2 AtlasCoord;
+flat out vec4 Color;
+
+void main(void){
+    // Triangle strip corners (0, 0), (1, 0), (0, 1), (1, 1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 position = vec2(rect.xy) + corner * vec2(rect.zw);
+
+    // Sprite row 0 is the top one, at the lowest atlas row
+    AtlasCoord = vec2(atlas_rect.xy) + vec2(corner.x, 1.0 - corner.y) * vec2(atlas_rect.zw);
+    Color = vec4((color >> 24) & 255u, (color >> 16) & 255u, (color >> 8) & 255u, color & 255u) / 255.0;
+
+    gl_Position = vec4(2.0 * position / screen_size - 1.0, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+uniform sampler2D atlas;
+uniform float brightness;
+noperspective in vec2 AtlasCoord;
+flat in vec4 Color;
+
+out vec4 FragColor;
+
+void main(void){
+    if (texelFetch(atlas, ivec2(AtlasCoord), 0).r == 0.0) discard;
+    FragColor = vec4(Color.rgb * brightness, Color.a);
+}
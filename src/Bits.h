@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit, mask must not be zero
+static inline unsigned count_trailing_zeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned count_trailing_zeros64(uint64_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+static inline unsigned popcount64(uint64_t mask)
+{
+#ifdef _MSC_VER
+	return static_cast<unsigned>(__popcnt64(mask));
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
+// Mask of the n lowest bits, n up to 64
+static inline uint64_t low_bits64(unsigned n)
+{
+	return n < 64 ? (uint64_t(1) << n) - 1 : ~uint64_t(0);
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include "CollisionGrid.h"
+
+CollisionGrid CreateCollisionGrid(const int16_t* x, const int16_t* y, const uint8_t* type, size_t num_aliens, const Sprite* alien_sprites) {
+	CollisionGrid grid;
+	grid.origin_x = 0;
+	grid.origin_y = 0;
+	grid.columns = 0;
+	grid.rows = 0;
+
+	ptrdiff_t max_x = 0, max_y = 0;
+	for (size_t ai = 0; ai < num_aliens; ++ai)
+	{
+		const Sprite& sprite = alien_sprites[2 * (type[ai] - 1)];
+		if (ai == 0 || x[ai] < grid.origin_x) grid.origin_x = x[ai];
+		if (ai == 0 || y[ai] < grid.origin_y) grid.origin_y = y[ai];
+		max_x = std::max(max_x, x[ai] + ptrdiff_t(sprite.width));
+		max_y = std::max(max_y, y[ai] + ptrdiff_t(sprite.height));
+	}
+	if (num_aliens)
+	{
+		grid.columns = (max_x - grid.origin_x + COLLISION_GRID_CELL_SIZE - 1) / COLLISION_GRID_CELL_SIZE;
+		grid.rows = (max_y - grid.origin_y + COLLISION_GRID_CELL_SIZE - 1) / COLLISION_GRID_CELL_SIZE;
+	}
+
+	size_t num_cells = grid.columns * grid.rows;
+	grid.cell_start = new size_t[num_cells + 1]();
+
+	// Two passes: count the aliens of each cell, then scatter their indices
+	// into the ranges given by the running sum of the counts
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (size_t ai = 0; ai < num_aliens; ++ai)
+		{
+			const Sprite& sprite = alien_sprites[2 * (type[ai] - 1)];
+			size_t c0 = (x[ai] - grid.origin_x) / COLLISION_GRID_CELL_SIZE;
+			size_t r0 = (y[ai] - grid.origin_y) / COLLISION_GRID_CELL_SIZE;
+			size_t c1 = (x[ai] + sprite.width - 1 - grid.origin_x) / COLLISION_GRID_CELL_SIZE;
+			size_t r1 = (y[ai] + sprite.height - 1 - grid.origin_y) / COLLISION_GRID_CELL_SIZE;
+
+			for (size_t r = r0; r <= r1; ++r)
+			{
+				for (size_t c = c0; c <= c1; ++c)
+				{
+					if (pass == 0) ++grid.cell_start[r * grid.columns + c + 1];
+					else grid.alien_indices[grid.cell_start[r * grid.columns + c]++] = ai;
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (size_t cell = 0; cell < num_cells; ++cell)
+			{
+				grid.cell_start[cell + 1] += grid.cell_start[cell];
+			}
+			grid.alien_indices = new size_t[grid.cell_start[num_cells]];
+		}
+		else
+		{
+			// Scattering advanced every start to the next cell's start
+			for (size_t cell = num_cells; cell > 0; --cell)
+			{
+				grid.cell_start[cell] = grid.cell_start[cell - 1];
+			}
+			grid.cell_start[0] = 0;
+		}
+	}
+
+	return grid;
+}
+
+void DestroyCollisionGrid(CollisionGrid& grid) {
+	delete[] grid.cell_start;
+	delete[] grid.alien_indices;
+	grid.cell_start = NULL;
+	grid.alien_indices = NULL;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include "Items.h"
+
+#define COLLISION_GRID_CELL_SIZE 16
+
+// Uniform grid over the alien formation, in formation coordinates (the
+// alien x/y before the formation offset is added). The whole formation
+// moves together, so the grid is built once and queried by moving the
+// query rectangle into formation space instead of rebuilding every tick.
+// Cells list the aliens overlapping them, packed as ranges of one array
+struct CollisionGrid
+{
+	ptrdiff_t origin_x, origin_y;
+	size_t columns, rows;
+	size_t* cell_start;
+	size_t* alien_indices;
+};
+
+// Takes the alien positions and types as parallel arrays, as laid out in
+// AlienArray. alien_sprites are indexed like the animation frames,
+// 2 * (type - 1)
+CollisionGrid CreateCollisionGrid(const int16_t* x, const int16_t* y, const uint8_t* type, size_t num_aliens, const Sprite* alien_sprites);
+void DestroyCollisionGrid(CollisionGrid& grid);
+
+// Calls visit(alien_index) for every alien sharing a cell with the
+// rectangle [x0, x1) x [y0, y1) given in formation coordinates. An alien
+// spanning several cells can be visited more than once
+template <typename Visit>
+void collision_grid_visit(const CollisionGrid& grid, ptrdiff_t x0, ptrdiff_t y0, ptrdiff_t x1, ptrdiff_t y1, Visit visit)
+{
+	x0 -= grid.origin_x;
+	x1 -= grid.origin_x;
+	y0 -= grid.origin_y;
+	y1 -= grid.origin_y;
+	if (x1 <= 0 || y1 <= 0 || x0 >= ptrdiff_t(grid.columns * COLLISION_GRID_CELL_SIZE) ||
+		y0 >= ptrdiff_t(grid.rows * COLLISION_GRID_CELL_SIZE)) return;
+
+	size_t c0 = x0 < 0 ? 0 : x0 / COLLISION_GRID_CELL_SIZE;
+	size_t r0 = y0 < 0 ? 0 : y0 / COLLISION_GRID_CELL_SIZE;
+	size_t c1 = (x1 - 1) / COLLISION_GRID_CELL_SIZE;
+	size_t r1 = (y1 - 1) / COLLISION_GRID_CELL_SIZE;
+	if (c1 >= grid.columns) c1 = grid.columns - 1;
+	if (r1 >= grid.rows) r1 = grid.rows - 1;
+
+	for (size_t r = r0; r <= r1; ++r)
+	{
+		for (size_t c = c0; c <= c1; ++c)
+		{
+			size_t cell = r * grid.columns + c;
+			for (size_t i = grid.cell_start[cell]; i < grid.cell_start[cell + 1]; ++i)
+			{
+				visit(grid.alien_indices[i]);
+			}
+		}
+	}
+}
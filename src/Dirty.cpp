@@ -0,0 +1,196 @@
+#include <algorithm>
+#include "Dirty.h"
+
+// How far ahead the diff looks for a draw that was inserted or removed
+#define DIRTY_LOOKAHEAD 16
+
+DirtyTracker* CreateDirtyTracker() {
+	DirtyTracker* tracker = new DirtyTracker;
+	tracker->num_records[0] = tracker->num_records[1] = 0;
+	tracker->overflow[0] = tracker->overflow[1] = false;
+	tracker->current = 0;
+	tracker->invalidated = true;
+	tracker->num_rects = 0;
+	return tracker;
+}
+
+void dirty_invalidate(DirtyTracker* tracker)
+{
+	tracker->invalidated = true;
+}
+
+void dirty_begin_frame(DirtyTracker* tracker)
+{
+	tracker->current ^= 1;
+	tracker->num_records[tracker->current] = 0;
+	tracker->overflow[tracker->current] = false;
+}
+
+void dirty_record(DirtyTracker* tracker, const void* source, ptrdiff_t x, ptrdiff_t y, ptrdiff_t width, ptrdiff_t height, uint32_t color)
+{
+	size_t& count = tracker->num_records[tracker->current];
+	if (count == DIRTY_MAX_RECORDS)
+	{
+		tracker->overflow[tracker->current] = true;
+		return;
+	}
+
+	DrawRecord& record = tracker->records[tracker->current][count++];
+	record.source = source;
+	record.rect.x = x;
+	record.rect.y = y;
+	record.rect.width = width;
+	record.rect.height = height;
+	record.color = color;
+}
+
+static bool same_draw(const DrawRecord& a, const DrawRecord& b)
+{
+	return a.source == b.source && a.color == b.color &&
+		a.rect.x == b.rect.x && a.rect.y == b.rect.y &&
+		a.rect.width == b.rect.width && a.rect.height == b.rect.height;
+}
+
+static ptrdiff_t area(const DirtyRect& r)
+{
+	return r.width * r.height;
+}
+
+static DirtyRect bounding_box(const DirtyRect& a, const DirtyRect& b)
+{
+	DirtyRect box;
+	box.x = std::min(a.x, b.x);
+	box.y = std::min(a.y, b.y);
+	box.width = std::max(a.x + a.width, b.x + b.width) - box.x;
+	box.height = std::max(a.y + a.height, b.y + b.height) - box.y;
+	return box;
+}
+
+static void add_rect(DirtyTracker* tracker, DirtyRect rect, ptrdiff_t width, ptrdiff_t height)
+{
+	ptrdiff_t x0 = std::max(rect.x, ptrdiff_t(0));
+	ptrdiff_t y0 = std::max(rect.y, ptrdiff_t(0));
+	ptrdiff_t x1 = std::min(rect.x + rect.width, width);
+	ptrdiff_t y1 = std::min(rect.y + rect.height, height);
+	if (x0 >= x1 || y0 >= y1) return;
+	rect.x = x0;
+	rect.y = y0;
+	rect.width = x1 - x0;
+	rect.height = y1 - y0;
+
+	// Merge with existing rectangles as long as little is wasted; merging
+	// can make the result overlap other rectangles, so keep going
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (size_t i = 0; i < tracker->num_rects; ++i)
+		{
+			DirtyRect box = bounding_box(tracker->rects[i], rect);
+			if (area(box) <= area(tracker->rects[i]) + area(rect) + DIRTY_MERGE_SLACK)
+			{
+				rect = box;
+				tracker->rects[i] = tracker->rects[--tracker->num_rects];
+				merged = true;
+				break;
+			}
+		}
+	}
+
+	if (tracker->num_rects < DIRTY_MAX_RECTS)
+	{
+		tracker->rects[tracker->num_rects++] = rect;
+		return;
+	}
+
+	// Out of rectangles: grow the one that wastes the least
+	size_t best = 0;
+	ptrdiff_t best_growth = 0;
+	for (size_t i = 0; i < tracker->num_rects; ++i)
+	{
+		ptrdiff_t growth = area(bounding_box(tracker->rects[i], rect)) - area(tracker->rects[i]);
+		if (i == 0 || growth < best_growth)
+		{
+			best = i;
+			best_growth = growth;
+		}
+	}
+	tracker->rects[best] = bounding_box(tracker->rects[best], rect);
+}
+
+static size_t find_draw(const DrawRecord* records, size_t begin, size_t end, const DrawRecord& draw)
+{
+	for (size_t i = begin; i < end && i < begin + DIRTY_LOOKAHEAD; ++i)
+	{
+		if (same_draw(records[i], draw)) return i - begin;
+	}
+	return DIRTY_LOOKAHEAD;
+}
+
+void dirty_end_frame(DirtyTracker* tracker, size_t width, size_t height)
+{
+	ptrdiff_t w = static_cast<ptrdiff_t>(width);
+	ptrdiff_t h = static_cast<ptrdiff_t>(height);
+	tracker->num_rects = 0;
+
+	size_t cur = tracker->current;
+	size_t prev = cur ^ 1;
+
+	if (tracker->invalidated || tracker->overflow[cur] || tracker->overflow[prev])
+	{
+		DirtyRect full = { 0, 0, w, h };
+		tracker->rects[tracker->num_rects++] = full;
+		tracker->invalidated = false;
+		return;
+	}
+
+	// Walk both frames in draw order, keeping the draws they have in common
+	// as a subsequence. A pixel covered only by common draws went through
+	// the same writes in the same order, so it did not change
+	const DrawRecord* a = tracker->records[prev];
+	const DrawRecord* b = tracker->records[cur];
+	size_t na = tracker->num_records[prev];
+	size_t nb = tracker->num_records[cur];
+	size_t i = 0, j = 0;
+
+	while (i < na && j < nb)
+	{
+		if (same_draw(a[i], b[j]))
+		{
+			++i;
+			++j;
+			continue;
+		}
+
+		size_t removed = find_draw(a, i + 1, na, b[j]);
+		size_t inserted = find_draw(b, j + 1, nb, a[i]);
+
+		if (inserted < DIRTY_LOOKAHEAD && inserted <= removed)
+		{
+			for (size_t k = 0; k <= inserted; ++k) add_rect(tracker, b[j + k].rect, w, h);
+			j += inserted + 1;
+		}
+		else if (removed < DIRTY_LOOKAHEAD)
+		{
+			for (size_t k = 0; k <= removed; ++k) add_rect(tracker, a[i + k].rect, w, h);
+			i += removed + 1;
+		}
+		else
+		{
+			add_rect(tracker, a[i++].rect, w, h);
+			add_rect(tracker, b[j++].rect, w, h);
+		}
+	}
+	for (; i < na; ++i) add_rect(tracker, a[i].rect, w, h);
+	for (; j < nb; ++j) add_rect(tracker, b[j].rect, w, h);
+
+	// Past half the buffer a single upload is cheaper than many small ones
+	ptrdiff_t total = 0;
+	for (size_t r = 0; r < tracker->num_rects; ++r) total += area(tracker->rects[r]);
+	if (total * 2 > w * h)
+	{
+		DirtyRect full = { 0, 0, w, h };
+		tracker->rects[0] = full;
+		tracker->num_rects = 1;
+	}
+}
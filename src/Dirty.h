@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#define DIRTY_MAX_RECORDS 512
+#define DIRTY_MAX_RECTS 16
+// Two rectangles are merged when their bounding box wastes at most this
+// many pixels over their combined area
+#define DIRTY_MERGE_SLACK 256
+
+// Rectangle in buffer coordinates, bottom left origin like Buffer
+struct DirtyRect
+{
+	ptrdiff_t x, y;
+	ptrdiff_t width, height;
+};
+
+// One draw call into the buffer: what was drawn, where and in which color
+struct DrawRecord
+{
+	const void* source;
+	DirtyRect rect;
+	uint32_t color;
+};
+
+// Remembers the draw calls of the current and previous frame. Draws that
+// are repeated identically (same source, position and color, in the same
+// relative order) leave the pixels untouched, so only the rectangles of
+// draws that appeared or disappeared need to be uploaded
+struct DirtyTracker
+{
+	DrawRecord records[2][DIRTY_MAX_RECORDS];
+	size_t num_records[2];
+	bool overflow[2];
+	size_t current;
+	bool invalidated;
+
+	DirtyRect rects[DIRTY_MAX_RECTS];
+	size_t num_rects;
+};
+
+DirtyTracker* CreateDirtyTracker();
+
+// Forces the next frame to be fully dirty, e.g. after the texture is created
+void dirty_invalidate(DirtyTracker* tracker);
+void dirty_begin_frame(DirtyTracker* tracker);
+void dirty_record(DirtyTracker* tracker, const void* source, ptrdiff_t x, ptrdiff_t y, ptrdiff_t width, ptrdiff_t height, uint32_t color);
+// Diffs this frame against the previous one and fills rects with the
+// merged regions, clipped to a width x height buffer
+void dirty_end_frame(DirtyTracker* tracker, size_t width, size_t height);
@@ -0,0 +1,115 @@
+#include "Fill.h"
+
+#ifdef FILL_HAS_X86_KERNELS
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+void fill_u32_scalar(uint32_t* dst, size_t count, uint32_t value)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = value;
+	}
+}
+
+#ifdef FILL_HAS_X86_KERNELS
+void fill_u32_sse2(uint32_t* dst, size_t count, uint32_t value)
+{
+	__m128i v = _mm_set1_epi32(static_cast<int>(value));
+	size_t i = 0;
+	for (; i < count && (reinterpret_cast<uintptr_t>(dst + i) & 15); ++i)
+	{
+		dst[i] = value;
+	}
+	for (; i + 16 <= count; i += 16)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst + i), v);
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 4), v);
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 8), v);
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 12), v);
+	}
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst + i), v);
+	}
+	for (; i < count; ++i)
+	{
+		dst[i] = value;
+	}
+}
+
+TARGET_AVX2 void fill_u32_avx2(uint32_t* dst, size_t count, uint32_t value)
+{
+	__m256i v = _mm256_set1_epi32(static_cast<int>(value));
+	size_t i = 0;
+
+	// 256-bit stores crossing a cache line are split, so align the
+	// destination first
+	for (; i < count && (reinterpret_cast<uintptr_t>(dst + i) & 31); ++i)
+	{
+		dst[i] = value;
+	}
+	for (; i + 32 <= count; i += 32)
+	{
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), v);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 8), v);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 16), v);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 24), v);
+	}
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), v);
+	}
+	for (; i < count; ++i)
+	{
+		dst[i] = value;
+	}
+}
+
+bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+
+	// AVX2 also needs the OS to save the YMM registers
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!osxsave || (_xgetbv(0) & 6) != 6) return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+static FillKernel select_fill_kernel()
+{
+#ifdef FILL_HAS_X86_KERNELS
+	if (cpu_has_avx2()) return fill_u32_avx2;
+	return fill_u32_sse2;
+#else
+	return fill_u32_scalar;
+#endif
+}
+
+FillKernel fill_u32 = select_fill_kernel();
+
+const char* fill_kernel_name()
+{
+#ifdef FILL_HAS_X86_KERNELS
+	if (fill_u32 == fill_u32_avx2) return "avx2";
+	if (fill_u32 == fill_u32_sse2) return "sse2";
+#endif
+	return "scalar";
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Kernels writing the same 32-bit value to count consecutive pixels
+typedef void (*FillKernel)(uint32_t* dst, size_t count, uint32_t value);
+
+void fill_u32_scalar(uint32_t* dst, size_t count, uint32_t value);
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_IX86)
+#define FILL_HAS_X86_KERNELS 1
+void fill_u32_sse2(uint32_t* dst, size_t count, uint32_t value);
+void fill_u32_avx2(uint32_t* dst, size_t count, uint32_t value);
+bool cpu_has_avx2();
+#endif
+
+// Best kernel for the running CPU, chosen once at startup
+extern FillKernel fill_u32;
+const char* fill_kernel_name();
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Simulation.h"
+#include "Replay.h"
+
+// Re-simulates every replay and checks it passes through every keyframe
+// and ends the way it was recorded
+static int verify_replays(int num_files, char** files)
+{
+	size_t verified = 0, failed = 0, ticks = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < num_files; ++i)
+	{
+		Replay replay;
+		if (!LoadReplay(files[i], &replay))
+		{
+			fprintf(stderr, "%s: not a valid replay\n", files[i]);
+			++failed;
+			continue;
+		}
+
+		size_t first_mismatch;
+		ReplayResult result = replay_simulate(&replay, BUILTIN_SPRITES, &first_mismatch);
+		const ReplayResult& recorded = replay.footer->result;
+		if (first_mismatch == SIZE_MAX && replay_results_equal(result, recorded)) ++verified;
+		else
+		{
+			if (first_mismatch != SIZE_MAX) fprintf(stderr, "%s: the game differs from its keyframe at tick %zu\n", files[i], first_mismatch);
+			fprintf(stderr, "%s: recorded score %llu, %u lives, aliens %016llx; replayed score %llu, %u lives, aliens %016llx\n",
+				files[i],
+				(unsigned long long)recorded.score, recorded.life, (unsigned long long)recorded.alive,
+				(unsigned long long)result.score, result.life, (unsigned long long)result.alive);
+			++failed;
+		}
+		ticks += replay.footer->num_ticks;
+		DestroyReplay(&replay);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	printf("Verified %zu replays, %zu failed, %zu ticks in %.3f s (%.0fx real time)\n",
+		verified, failed, ticks, seconds, ticks / seconds / SIMULATION_TICK_RATE);
+	return failed ? 1 : 0;
+}
+
+static ReplayRecorder* start_replay(const char* dir, size_t game, uint32_t seed)
+{
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/game%05zu.replay", dir, game);
+	ReplayRecorder* recorder = CreateReplayRecorder(path, seed);
+	if (!recorder) fprintf(stderr, "Error creating %s\n", path);
+	return recorder;
+}
+
+static void finish_replay(ReplayRecorder* recorder, const Simulation& sim)
+{
+	if (!replay_recorder_finish(recorder, sim)) fprintf(stderr, "Error writing a replay\n");
+	DestroyReplayRecorder(recorder);
+}
+
+// Runs the simulation without any window or GL context, driven by a simple
+// bot, and reports how many ticks per second the CPU can sustain.
+// With --record, every game is also written to DIR as a replay, and
+// --verify re-simulates replays and checks their end state.
+// Usage: Headless [ticks] [--record DIR]
+//        Headless --verify FILE...
+int main(int argc, char** argv) {
+	size_t ticks = 1000000;
+	const char* record_dir = NULL;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--verify") == 0) return verify_replays(argc - i - 1, argv + i + 1);
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) record_dir = argv[++i];
+		else ticks = strtoull(argv[i], NULL, 10);
+	}
+
+	// The bot has a generator of its own, the games' draws only depend on
+	// their seed
+	Random bot = CreateRandom(1);
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	uint32_t seed = 1;
+	Simulation* sim = new Simulation(sprites, seed);
+	ReplayRecorder* recorder = record_dir ? start_replay(record_dir, 1, seed) : NULL;
+
+	size_t games = 1;
+	size_t total_score = 0;
+	Input input = { 0, false };
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t t = 0; t < ticks; ++t)
+	{
+		// Wander left and right, turning every half second and firing four
+		// times a second
+		if (t % (SIMULATION_TICK_RATE / 2) == 0) input.move_dir = static_cast<int>(random_below(bot, 3)) - 1;
+		input.fire = (t % (SIMULATION_TICK_RATE / 4) == 0);
+
+		if (recorder) replay_record(recorder, *sim, input);
+		sim->step(input);
+
+		if (sim->game.gameOver)
+		{
+			total_score += sim->game.score;
+			if (recorder) finish_replay(recorder, *sim);
+			delete sim;
+			sim = new Simulation(sprites, ++seed);
+			++games;
+			recorder = record_dir ? start_replay(record_dir, games, seed) : NULL;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	total_score += sim->game.score;
+	printf("Simulated %zu ticks (%zu games) in %.3f s\n", ticks, games, seconds);
+	printf("%.0f ticks/s, %.1fx real time\n", ticks / seconds, ticks / seconds / SIMULATION_TICK_RATE);
+	printf("Total score: %zu\n", total_score);
+
+	// The game still running is recorded as it stands
+	if (recorder) finish_replay(recorder, *sim);
+	delete sim;
+
+	return 0;
+}
@@ -1,60 +0,0 @@
-#include <cstdint>
-#define GAME_MAX_BULLETS 128
-
-enum AlienType : uint8_t
-{
-	ALIEN_DEAD = 0,
-	ALIEN_TYPE_A = 1,
-	ALIEN_TYPE_B = 2,
-	ALIEN_TYPE_C = 3
-};
-
-struct Buffer
-{
-	size_t width, height;
-	uint32_t* data;
-};
-
-struct Sprite
-{
-	size_t width, height;
-	uint8_t* data;
-};
-
-struct Alien
-{
-	size_t x, y;
-	uint8_t type;
-};
-
-struct Player
-{
-	size_t x, y;
-	size_t life;
-};
-
-struct Bullet
-{
-	size_t x, y;
-	int dir;
-	bool alienBullet;
-};
-
-struct Game
-{
-	size_t width, height;
-	size_t num_aliens;
-	size_t num_bullets;
-	Alien* aliens;
-	Player player;
-	Bullet bullets[GAME_MAX_BULLETS];
-};
-
-struct SpriteAnimation
-{
-	bool loop;
-	size_t num_frames;
-	size_t frame_duration;
-	size_t time;
-	Sprite** frames;
-};
\ No newline at end of file
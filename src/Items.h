@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Bits.h"
+#include "Random.h"
+#define GAME_MAX_ALIENS 64
+// Aliens of the formation a game starts with, the most it ever has
+#define GAME_FORMATION_ALIENS 55
+#define GAME_MAX_BULLETS 128
+
+enum AlienType : uint8_t
+{
+	ALIEN_DEAD = 0,
+	ALIEN_TYPE_A = 1,
+	ALIEN_TYPE_B = 2,
+	ALIEN_TYPE_C = 3
+};
+
+struct DirtyTracker;
+struct DrawList;
+
+struct Buffer
+{
+	size_t width, height;
+	uint32_t* data;
+	// Optional, records every draw so only changed regions get uploaded
+	DirtyTracker* dirty;
+	// Optional, when set draws are only recorded there for a
+	// TileRasterizer and data is not touched
+	DrawList* draws;
+};
+
+// Sprites are one bit mask per row (bit i is column i), row 0 on top.
+// The rows belong to a constant table or a SpriteBlob, never to the sprite
+#define SPRITE_MAX_WIDTH 32
+
+struct Sprite
+{
+	size_t width, height;
+	const uint32_t* rows;
+};
+
+// Aliens are stored as parallel arrays so the sweeps over positions or
+// types only touch the bytes they need. Bit i of alive is set while alien
+// i is alive; a dead alien keeps its type and position, and shows the
+// death sprite until its death counter is down to zero
+struct AlienArray
+{
+	int16_t x[GAME_MAX_ALIENS];
+	int16_t y[GAME_MAX_ALIENS];
+	uint8_t type[GAME_MAX_ALIENS];
+	uint8_t death_counters[GAME_MAX_ALIENS];
+	uint64_t alive;
+	uint32_t count;
+	uint32_t padding;
+};
+
+struct Player
+{
+	int16_t x, y;
+	int16_t life;
+};
+
+// Bullets are packed in the first count slots. Player bullets move up and
+// alien bullets down, so the direction is a single bit per bullet
+struct BulletArray
+{
+	int16_t x[GAME_MAX_BULLETS];
+	int16_t y[GAME_MAX_BULLETS];
+	uint64_t from_alien[GAME_MAX_BULLETS / 64];
+	uint32_t count;
+	uint32_t padding;
+};
+
+// Everything that changes while a game is played, in one struct with no
+// pointers and no padding. Copying a game, to search ahead from it or
+// store it, is a memcpy, and two games compare equal with memcmp
+struct Game
+{
+	AlienArray aliens;
+	BulletArray bullets;
+	// Picks the aliens that fire, seeded when the game is created
+	Random random;
+	uint32_t score, tick;
+	uint32_t last_fire_tick;
+	int32_t total_aliens;
+	// The formation offset, added to every alien position
+	float xi, yi;
+	float alienMoveDir;
+	// Values before the last tick, for interpolating between ticks
+	float prev_xi, prev_yi;
+	int32_t lastAlienX;
+	Player player;
+	int16_t prev_player_x;
+	uint16_t width, height;
+	// Ticks into the alien animation, the same for every type
+	uint8_t animation_time;
+	bool lastAlien;
+	bool gameOver;
+	uint8_t padding[1];
+};
+
+inline bool alien_alive(const AlienArray& aliens, size_t i)
+{
+	return (aliens.alive >> i) & 1;
+}
+
+// Calls f(i) for every alive alien, in increasing index order
+template <typename F>
+inline void for_each_alive_alien(const AlienArray& aliens, F f)
+{
+	for (uint64_t mask = aliens.alive; mask; mask &= mask - 1)
+	{
+		f(static_cast<size_t>(count_trailing_zeros64(mask)));
+	}
+}
+
+inline bool bullet_from_alien(const BulletArray& bullets, size_t i)
+{
+	return (bullets.from_alien[i / 64] >> (i % 64)) & 1;
+}
+
+inline void bullet_add(BulletArray& bullets, int16_t x, int16_t y, bool from_alien)
+{
+	size_t i = bullets.count++;
+	bullets.x[i] = x;
+	bullets.y[i] = y;
+	uint64_t bit = uint64_t(1) << (i % 64);
+	if (from_alien) bullets.from_alien[i / 64] |= bit;
+	else bullets.from_alien[i / 64] &= ~bit;
+}
+
+// Removes bullet i by moving the last bullet into its slot
+inline void bullet_remove(BulletArray& bullets, size_t i)
+{
+	size_t last = --bullets.count;
+	bullets.x[i] = bullets.x[last];
+	bullets.y[i] = bullets.y[last];
+	uint64_t bit = uint64_t(1) << (i % 64);
+	if (bullet_from_alien(bullets, last)) bullets.from_alien[i / 64] |= bit;
+	else bullets.from_alien[i / 64] &= ~bit;
+}
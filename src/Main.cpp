@@ -1,15 +1,44 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <iostream>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include "shaderFunctions.cpp"
-#include "Items.cpp"
+#include "Items.h"
+#include "Sprites.h"
+#include "Simulation.h"
+#include "Render.h"
+#include "Dirty.h"
+#include "PboRing.h"
+#include "PhaseTimers.h"
+#include "TripleBuffer.h"
+#include "TileRaster.h"
+#include "SpriteAtlas.h"
+#include "SpriteRenderer.h"
+#include "SpriteBlob.h"
+#include "Replay.h"
+#include "Rewind.h"
+#include "SimulationLoop.h"
+
+// The build passes the absolute path of the shaders directory. Without
+// it, look for it relative to the working directory, the project
+// directory when run from Visual Studio
+#ifndef SHADER_DIR
+#define SHADER_DIR "shaders"
+#endif
+// Same for the sprites packed by atlaspacker
+#ifndef SPRITE_BLOB
+#define SPRITE_BLOB "sprites.blob"
+#endif
 
 GLFWwindow* window = NULL;
 int buffer_width = 224, buffer_height = 256;
-size_t score = 0;
 using namespace std;
 
 #define GL_ERROR_CASE(glerror)\
@@ -36,28 +65,79 @@ inline void gl_debug(const char* file, int line) {
 #undef GL_ERROR_CASE
 
 void error_callback(int error, const char* description);
-uint32_t rgb_to_uint32(uint8_t r, uint8_t g, uint8_t b);
-void buffer_clear(Buffer* buffer, uint32_t color);
-void buffer_draw_sprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t color);
 bool validate_program(GLuint program);
 void validate_shader(GLuint shader, const char* file);
 void CreateTexture(GLuint &buffer_texture, Buffer buffer);
-Sprite CreatePlayer();
 Buffer CreateBuffer();
-Game CreateGame();
-SpriteAnimation* CreateAnimation(Sprite* alien_sprites);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
-Sprite CreateBullet();
-Sprite* CreateAlienSprites();
-Sprite CreateDeathSprite();
-bool sprite_overlap_check(const Sprite& sp_a, size_t x_a, size_t y_a, const Sprite& sp_b, size_t x_b, size_t y_b);
-Sprite CreateTextSprite(char letter);
 
-bool game_running = false;
-int move_dir = 0;
-bool fire_pressed = 0;
+// Written by the key callback on the GL thread, read by the simulation thread
+std::atomic<bool> game_running(false);
+Controls controls;
+std::atomic<bool> show_timers(false);
+
+// Everything the simulation thread works with. It steps the simulation
+// in real time and draws finished frames into the triple buffer, so the
+// GL thread only uploads and presents them, and a driver stall no longer
+// delays the simulation nor the other way around
+struct SimulationThread
+{
+	Simulation* sim;
+	const GameSprites* sprites;
+	const GlyphAtlas* glyphs;
+	TripleBuffer* frames;
+	DirtyTracker* dirty;
+	PhaseTimers* timers;
+	// Size of the game screen. Above 1x the frames are scale times larger,
+	// and the draws are recorded and drawn by the tiled rasterizer
+	size_t width, height;
+	size_t scale;
+	DrawList* draws;
+	TileRasterizer* rasterizer;
+	// Set for the GPU backend, the draws are then turned into instances
+	// of the atlas sprites instead of pixels
+	const SpriteAtlas* atlas;
+	// Optional, every tick's input is recorded there
+	ReplayRecorder* replay;
+	// Optional, history to step back through while backspace is held
+	RewindBuffer* rewind;
+};
+
+static void run_simulation_thread(SimulationThread* thread);
+
+// Usage: Space Invaders [--no-vsync] [--gpu | --scale N] [--timings PATH] [--trace FILE] [--record FILE]
+// The simulation runs at a fixed rate, so --no-vsync only lowers input
+// latency and never changes the game speed. --gpu draws the sprites as
+// instanced quads instead of rasterizing them on the CPU. --scale draws
+// the frames at N times the game's resolution, up to 8, with every core
+// rasterizing tiles. With --timings, the phase statistics are written to
+// PATH.csv and PATH.json on exit. F3 toggles them on screen either way. With --trace,
+// every phase and GL call of the last frames is written to FILE as
+// Chrome trace JSON, for chrome://tracing or Perfetto. With --record, the
+// seed and every tick's input are written to FILE as the game is played,
+// with keyframes to seek in it, for headless --verify to play it again.
+// Otherwise holding backspace rewinds the game, as far as the last few
+// hours; a replay can not follow the game back in time
+int main(int argc, char** argv) {
+    const char* timings_path = NULL;
+    const char* trace_path = NULL;
+    const char* replay_path = NULL;
+    bool vsync = true;
+    size_t scale = 1;
+    bool gpu = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--no-vsync") == 0) vsync = false;
+        else if (strcmp(argv[i], "--gpu") == 0) gpu = true;
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) scale = std::min(std::max(atoi(argv[++i]), 1), 8);
+        else if (strcmp(argv[i], "--timings") == 0 && i + 1 < argc) timings_path = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) trace_path = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) replay_path = argv[++i];
+    }
+    if (trace_path) trace_ring = CreateTraceRing();
+    // The GPU draws at the window's resolution whatever the scale
+    if (gpu) scale = 1;
 
-int main(void) {
     const size_t buffer_width = 224;
     const size_t buffer_height = 256;
 
@@ -100,15 +180,17 @@ int main(void) {
     printf("Renderer used: %s\n", glGetString(GL_RENDERER));
     printf("Shading Language: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
 
-    glfwSwapInterval(1);
+    glfwSwapInterval(vsync ? 1 : 0);
 
     glClearColor(1.0, 0.0, 0.0, 1.0);
 
     // Create graphics buffer
     Buffer buffer;
-    buffer.width = buffer_width;
-    buffer.height = buffer_height;
+    buffer.width = buffer_width * scale;
+    buffer.height = buffer_height * scale;
     buffer.data = new uint32_t[buffer.width * buffer.height];
+    buffer.dirty = NULL;
+    buffer.draws = NULL;
 
     buffer_clear(&buffer, 0);
 
@@ -122,11 +204,32 @@ int main(void) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    // Only the regions that changed since the last frame get uploaded, as
+    // sub-rectangles of the buffer rows
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer.width);
+
+    // From now on frames are drawn by the simulation thread, and copied
+    // into pixel buffer objects for the upload
+    PboRing* pbo_ring = CreatePboRing(buffer.width, buffer.height);
+    TripleBuffer* frames = CreateTripleBuffer(buffer.width, buffer.height);
+    DirtyTracker* dirty = CreateDirtyTracker();
+    DrawList* draws = NULL;
+    ThreadPool* pool = NULL;
+    TileRasterizer* rasterizer = NULL;
+    if (scale > 1 || gpu) draws = new DrawList;
+    if (scale > 1)
+    {
+        pool = CreateThreadPool(0);
+        rasterizer = CreateTileRasterizer(buffer_width, buffer_height, scale, pool);
+    }
+    delete[] buffer.data;
+    buffer.data = NULL;
+
 
     // Create vao for generating fullscreen triangle
 	GLuint fullscreen_triangle_vao;
 	glGenVertexArrays(1, &fullscreen_triangle_vao);
-	ShaderProgramSource source = ParseShader("C:/Users/luiza/source/repos/Space Invaders/shaders/Source.shader");
+	ShaderProgramSource source = ParseShader(SHADER_DIR "/Source.shader");
 
     // Create shader for displaying buffer
     unsigned int shader_id = createShader(source.VertexSource, source.FragmentSource);
@@ -134,9 +237,17 @@ int main(void) {
 
     if (!validate_program(shader_id)) {
         fprintf(stderr, "Error while validating shader.\n");
+        DestroyPboRing(pbo_ring);
         glfwTerminate();
         glDeleteVertexArrays(1, &fullscreen_triangle_vao);
-        delete[] buffer.data;
+        DestroyTripleBuffer(frames);
+        delete dirty;
+        delete draws;
+        if (rasterizer)
+        {
+            DestroyTileRasterizer(rasterizer);
+            DestroyThreadPool(pool);
+        }
         return -1;
     }
 
@@ -148,33 +259,49 @@ int main(void) {
 	// After linking the shader program, get the brightness uniform location
 	GLint brightnessLocation = glGetUniformLocation(shader_id, "brightness");
 
-	float brightness = 1.0f;  // Default brightness
-
     //OpenGL setup
     glDisable(GL_DEPTH_TEST);
     glActiveTexture(GL_TEXTURE0);
 
     glBindVertexArray(fullscreen_triangle_vao);
 
-    // Prepare game
-    Sprite *alien_sprites = CreateAlienSprites();
-
-    Sprite alien_death_sprite = CreateDeathSprite();
+    // Prepare game. The sprites are read from the packed blob when there
+    // is one, and are the tables built into Sprites.cpp otherwise
+    SpriteBlob sprite_blob;
+    bool from_blob = LoadSpriteBlob(SPRITE_BLOB, &sprite_blob);
+    GameSprites sprites = from_blob ? sprite_blob_game_sprites(&sprite_blob) : BUILTIN_SPRITES;
 
-    Sprite player_sprite = CreatePlayer();
+	GlyphAtlas glyphs = from_blob ? sprite_blob_glyphs(&sprite_blob) : BUILTIN_GLYPHS;
 
-    Sprite bullet_sprite = CreateBullet();
-
-	Sprite text[5];
-	text[0] = CreateTextSprite('S');
-	text[1] = CreateTextSprite('C');
-	text[2] = CreateTextSprite('O');
-	text[3] = CreateTextSprite('R');
-	text[4] = CreateTextSprite('E');
+	SpriteAtlas atlas = CreateSpriteAtlas(sprites, glyphs);
+	SpriteRenderer* sprite_renderer = NULL;
+	if (gpu)
+	{
+		ShaderProgramSource sprite_source = ParseShader(SHADER_DIR "/Sprite.shader");
+		unsigned int sprite_program = createShader(sprite_source.VertexSource, sprite_source.FragmentSource);
+		if (validate_program(sprite_program))
+		{
+			sprite_renderer = CreateSpriteRenderer(atlas, sprite_program, buffer_width, buffer_height);
+		}
+		else
+		{
+			fprintf(stderr, "Error while validating the sprite shader, drawing on the CPU.\n");
+			glDeleteProgram(sprite_program);
+			delete draws;
+			draws = NULL;
+		}
+	}
 
-	SpriteAnimation *alien_animation = CreateAnimation(alien_sprites);
+	uint32_t seed = static_cast<uint32_t>(time(NULL));
+	Simulation sim(sprites, seed);
+	ReplayRecorder* replay = replay_path ? CreateReplayRecorder(replay_path, seed) : NULL;
+	if (replay_path && !replay) fprintf(stderr, "Error creating the replay %s\n", replay_path);
+	// Around 6 bytes a tick, 16 MB keeps over 6 hours
+	RewindBuffer* rewind = replay_path ? NULL : CreateRewindBuffer(16 << 20);
 
-    Game game = CreateGame();
+	PhaseTimers* timers = CreatePhaseTimers("simulation");
+	PhaseTimers* present_timers = CreatePhaseTimers("present");
+	sim.timers = timers;
 
 	GLuint vao, vbo;
 	glGenVertexArrays(1, &vao);
@@ -182,359 +309,267 @@ int main(void) {
 	glBindVertexArray(vao);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
-	size_t aliensRow = 11, offset = alien_death_sprite.width/3, aliensColumn = 5;
-	size_t margin = (game.width - (alien_death_sprite.width * aliensRow + offset * (aliensRow - 1)))/2;
-	
-    for (size_t yi = 0; yi < aliensColumn; ++yi)
-    {
-        for (size_t xi = 0; xi < aliensRow; ++xi)
-        {
-            Alien& alien = game.aliens[yi * 11 + xi];
-            alien.type = (5 - yi) / 2 + 1;
-
-            const Sprite& sprite = alien_sprites[2 * (alien.type - 1)];
-
-			alien.x = margin + xi * (offset + alien_death_sprite.width);
-			alien.y = 17 * yi + 128;
-        }
-    }
-
-    uint8_t* death_counters = new uint8_t[game.num_aliens];
-    for (size_t i = 0; i < game.num_aliens; ++i)
-    {
-        death_counters[i] = 10;
-    }
+	glUseProgram(shader_id);
+	glUniform1f(brightnessLocation, 1.0f);
+
+	SimulationThread simulation_thread;
+	simulation_thread.sim = &sim;
+	simulation_thread.sprites = &sprites;
+	simulation_thread.glyphs = &glyphs;
+	simulation_thread.frames = frames;
+	simulation_thread.dirty = dirty;
+	simulation_thread.timers = timers;
+	simulation_thread.width = buffer_width;
+	simulation_thread.height = buffer_height;
+	simulation_thread.scale = scale;
+	simulation_thread.draws = draws;
+	simulation_thread.rasterizer = rasterizer;
+	simulation_thread.atlas = sprite_renderer ? &atlas : NULL;
+	simulation_thread.replay = replay;
+	simulation_thread.rewind = rewind;
+
+	game_running = true;
+	std::thread worker(run_simulation_thread, &simulation_thread);
+
+	// Sequence of the frame the texture or instance buffer holds
+	uint64_t presented = 0;
+	float brightness = 1.0f;
+	const DirtyRect full_frame = { 0, 0, ptrdiff_t(buffer.width), ptrdiff_t(buffer.height) };
 
-    uint32_t clear_color = rgb_to_uint32(0, 128, 0);
-	bool gameOver = false;
-    game_running = true;
-	float startTime = glfwGetTime();
-    int player_move_dir = 0;
-	float xi = 0, yi = 0;
-	float alienMoveDir = 0.25;
-	int total_aliens = game.num_aliens;
-	size_t x, y;
-	bool lastAlien = false;
-    
 	while (!glfwWindowShouldClose(window) && game_running)
 	{
-		buffer_clear(&buffer, clear_color);
-
-		// Draw
-		int text_size = 0;
-		for (int i = 0; i < 5; i++)
+		ScopedPhase phase(present_timers, PHASE_UPLOAD);
+		const Frame* frame = triple_buffer_acquire(frames);
+		if (frame && sprite_renderer)
 		{
-			text_size = 5 + i * (text[i].width + 1);
-			buffer_draw_sprite(&buffer, text[i], text_size, buffer_height - 15, rgb_to_uint32(128, 0, 0));
-		}
-
-		string s = to_string(score);
-		int len = s.length();
-		for (int i = 0; i < len; i++) {
-			Sprite scoreSprite = CreateTextSprite(s[i]);
-			buffer_draw_sprite(&buffer, scoreSprite, text_size + 10 + i * (scoreSprite.width + 1), buffer_height - 15, rgb_to_uint32(128, 0, 0));
-		}
-
-		for (size_t i = 0; i < game.player.life; i++) {
-			Sprite life_sprite = CreatePlayer();
-			buffer_draw_sprite(&buffer, life_sprite, (buffer_width - 15 - i * (life_sprite.width + 2)), buffer_height - 15, rgb_to_uint32(128, 0, 0));
+			sprite_renderer_upload(sprite_renderer, frame->instances, frame->num_instances);
+			brightness = frame->brightness;
+			presented = frame->sequence;
 		}
-
-		for (size_t ai = 0; ai < game.num_aliens; ++ai)
+		else if (frame)
 		{
-			if (!death_counters[ai]) continue;
-
-			const Alien& alien = game.aliens[ai];
-			if (alien.type == ALIEN_DEAD)
-			{
-				buffer_draw_sprite(&buffer, alien_death_sprite, alien.x + xi / 2, alien.y + yi, rgb_to_uint32(128, 0, 0));
-			}
-			else
+			// The rectangles only cover what changed since the frame before,
+			// so when frames were skipped the whole frame goes up
+			const DirtyRect* rects = frame->rects;
+			size_t num_rects = frame->num_rects;
+			if (frame->sequence != presented + 1)
 			{
-				const SpriteAnimation& animation = alien_animation[alien.type - 1];
-				size_t current_frame = animation.time / animation.frame_duration;
-				const Sprite& sprite = *animation.frames[current_frame];
-				buffer_draw_sprite(&buffer, sprite, alien.x + xi / 2, alien.y + yi, rgb_to_uint32(128, 0, 0));
+				rects = &full_frame;
+				num_rects = 1;
 			}
+			// Frames are drawn in client memory and only their rectangles
+			// copied here: the fences, mapping and orphaning need this
+			// thread's context, and orphaned storage is undefined while a
+			// frame must stay whole for the full uploads after skipped ones.
+			// BM_CopyRects measures the copy
+			buffer_copy_rects(&frame->buffer, pbo_ring_begin_frame(pbo_ring), rects, num_rects);
+			pbo_ring_upload(pbo_ring, frame->buffer, rects, num_rects);
+			glUniform1f(brightnessLocation, frame->brightness);
+			presented = frame->sequence;
 		}
 
-		for (size_t bi = 0; bi < game.num_bullets; ++bi)
+		if (sprite_renderer)
 		{
-			const Bullet& bullet = game.bullets[bi];
-			const Sprite& sprite = bullet_sprite;
-			size_t y;
-			if (bullet.alienBullet) y = bullet.y + yi;
-			else y = bullet.y;
-			buffer_draw_sprite(&buffer, sprite, bullet.x, y, rgb_to_uint32(128, 0, 0));
+			sprite_renderer_draw(sprite_renderer, brightness);
 		}
-
-		buffer_draw_sprite(&buffer, player_sprite, game.player.x, game.player.y, rgb_to_uint32(128, 0, 0));
-
-		// Update animations
-		for (size_t i = 0; i < 3; ++i)
+		else
 		{
-			++alien_animation[i].time;
-			if (alien_animation[i].time == alien_animation[i].num_frames * alien_animation[i].frame_duration)
-			{
-				alien_animation[i].time = 0;
-			}
+			ScopedTrace trace("glDrawArrays");
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 		}
 
-		glTexSubImage2D(
-			GL_TEXTURE_2D, 0, 0, 0,
-			buffer.width, buffer.height,
-			GL_RGBA, GL_UNSIGNED_INT_8_8_8_8,
-			buffer.data
-		);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
+		phase.next(PHASE_SWAP);
 		glfwSwapBuffers(window);
+		phase.stop();
 
-		// Simulate aliens
-		for (size_t ai = 0; ai < game.num_aliens; ++ai)
 		{
-			const Alien& alien = game.aliens[ai];
-			if (alien.type == ALIEN_DEAD && death_counters[ai])
-			{
-				--death_counters[ai];
-			}
+			ScopedTrace trace("glfwPollEvents");
+			glfwPollEvents();
 		}
+		phase_timers_end_frame(present_timers);
+	}
 
-		// Simulate bullets
-		for (size_t bi = 0; bi < game.num_bullets;)
-		{
-			game.bullets[bi].y += game.bullets[bi].dir;
-			if (game.bullets[bi].y >= game.height || game.bullets[bi].y < bullet_sprite.height)
-			{
-				game.bullets[bi] = game.bullets[game.num_bullets - 1];
-				--game.num_bullets;
-				continue;
-			}
+	game_running = false;
+	worker.join();
 
-			// Check hit
-			for (size_t ai = 0; ai < game.num_aliens; ++ai)
-			{
-				if (!game.bullets[bi].alienBullet)
-				{
-					const Alien& alien = game.aliens[ai];
-					if (alien.type == ALIEN_DEAD) continue;
-
-					const SpriteAnimation& animation = alien_animation[alien.type - 1];
-					size_t current_frame = animation.time / animation.frame_duration;
-					const Sprite& alien_sprite = *animation.frames[current_frame];
-
-					bool overlap = sprite_overlap_check(
-						bullet_sprite, game.bullets[bi].x, game.bullets[bi].y,
-						alien_sprite, alien.x + xi / 2, alien.y + yi);
-
-					if (overlap)
-					{
-						score += ((4 - static_cast<int>(game.aliens[ai].type)) * 10);
-						game.aliens[ai].type = ALIEN_DEAD;
-						// NOTE: Hack to recenter death sprite
-						game.aliens[ai].x -= (alien_death_sprite.width - alien_sprite.width) / 2;
-						game.bullets[bi] = game.bullets[game.num_bullets - 1];
-						--game.num_bullets;
-						--total_aliens;
-
-						continue;
-					}
-				}
-				else {
-					const Player& player = game.player;
-
-					bool overlap = sprite_overlap_check(
-						bullet_sprite, game.bullets[bi].x, game.bullets[bi].y,
-						player_sprite, player.x, player.y);
-
-					if (overlap && game.num_bullets)
-					{
-						game.player.life--;
-
-						game.bullets[bi] = game.bullets[game.num_bullets - 1];
-						--game.num_bullets;
-
-						continue;
-					}
-					continue;
-				}
-			}
+    if (replay)
+    {
+        if (!replay_recorder_finish(replay, sim))
+        {
+            fprintf(stderr, "Error writing the replay to %s\n", replay_path);
+        }
+        DestroyReplayRecorder(replay);
+    }
+    if (rewind) DestroyRewindBuffer(rewind);
 
-			++bi;
-		}
+    if (timings_path)
+    {
+        string csv_path = string(timings_path) + ".csv";
+        string json_path = string(timings_path) + ".json";
+        const PhaseTimers* all_timers[] = { timers, present_timers };
+        if (!phase_timers_write_csv(all_timers, 2, csv_path.c_str()) || !phase_timers_write_json(all_timers, 2, json_path.c_str()))
+        {
+            fprintf(stderr, "Error writing the phase timings to %s\n", timings_path);
+        }
+    }
+    delete timers;
+    delete present_timers;
 
-		// Simulate player
-		player_move_dir = 2 * move_dir;
+    if (trace_ring)
+    {
+        if (!trace_write_json(trace_ring, trace_path))
+        {
+            fprintf(stderr, "Error writing the trace to %s\n", trace_path);
+        }
+        delete trace_ring;
+        trace_ring = NULL;
+    }
 
-		if (player_move_dir != 0)
-		{
-			if (game.player.x + player_sprite.width + player_move_dir >= game.width)
-			{
-				game.player.x = game.width - player_sprite.width;
-			}
-			else if ((int)game.player.x + player_move_dir <= 0)
-			{
-				game.player.x = 0;
-			}
-			else game.player.x += player_move_dir;
-		}
+    DestroyPboRing(pbo_ring);
+    if (sprite_renderer) DestroySpriteRenderer(sprite_renderer);
 
-		// Process events
-		if (fire_pressed && game.num_bullets < GAME_MAX_BULLETS)
-		{
-			game.bullets[game.num_bullets].x = game.player.x + player_sprite.width / 2;
-			game.bullets[game.num_bullets].y = game.player.y + player_sprite.height;
-			game.bullets[game.num_bullets].dir = 2;
-			game.bullets[game.num_bullets].alienBullet = false;
-			++game.num_bullets;
-		}
-		fire_pressed = false;
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glfwDestroyWindow(window);
+    glfwTerminate();
 
-		// Randomize alien bullets every 3 seconds
-		if (glfwGetTime() - startTime > 3 && !gameOver) {
-			srand(time(NULL));
-			size_t i = rand() % game.num_aliens;
+    glDeleteVertexArrays(1, &fullscreen_triangle_vao);
 
-			while (game.aliens[i].type == ALIEN_DEAD)
-				i = rand() % game.num_aliens;
+    if (from_blob)
+    {
+        DestroySpriteBlob(&sprite_blob);
+    }
+    DestroyTripleBuffer(frames);
+    DestroySpriteAtlas(atlas);
+    delete dirty;
+    delete draws;
+    if (rasterizer)
+    {
+        DestroyTileRasterizer(rasterizer);
+        DestroyThreadPool(pool);
+    }
 
-			game.bullets[game.num_bullets].x = game.aliens[i].x + alien_sprites[game.aliens[i].type].width / 2;
-			game.bullets[game.num_bullets].y = game.aliens[i].y + alien_sprites[game.aliens[i].type].height;
-			game.bullets[game.num_bullets].dir = -2;
-			game.bullets[game.num_bullets].alienBullet = true;
-			++game.num_bullets;
+    return 0;
+}
 
-			startTime = glfwGetTime();
-		}
 
-		if (score >= 990 || game.player.life == 0) {
-			brightness -= 0.01f;  // Gradually darken the screen
-			if (brightness < 0.3f) brightness = 0.3f;  // Clamp to 0.3
-			glfwSetKeyCallback(window, NULL);
-			gameOver = true;
-		}
+static void run_simulation_thread(SimulationThread* thread)
+{
+	Simulation& sim = *thread->sim;
+	const Game& game = sim.game;
+	const GameSprites& sprites = *thread->sprites;
+	const GlyphAtlas& glyphs = *thread->glyphs;
+	PhaseTimers* timers = thread->timers;
 
-		// Set the brightness uniform in the shader
-		glUniform1f(brightnessLocation, brightness);
+	uint32_t clear_color = rgb_to_uint32(0, 128, 0);
+	uint64_t sequence = 0;
 
-		glfwPollEvents();
+	SimulationLoop loop = CreateSimulationLoop(&sim, thread->frames, &controls, glfwGetTime());
+	loop.replay = thread->replay;
+	loop.rewind = thread->rewind;
 
-		// Update alien positions
-		if (((xi >= static_cast<float>(offset) * aliensRow) || (xi <= -static_cast<float>(offset) * aliensRow) && (total_aliens > 1)) && !lastAlien)
-		{
-			yi -= 5;
-			alienMoveDir *= -1;
-		}
-		else if (total_aliens == 1 && !lastAlien)
+	while (game_running)
+	{
+		// The game keeps stepping while the GL thread has not taken the
+		// last frame, only the drawing waits for it
+		if (!simulation_loop_pass(&loop, glfwGetTime()))
 		{
-			// Find last alien's position and update bool lastAlien
-			for (size_t i = 0; i < game.num_aliens; i ++) {
-				if (game.aliens[i].type != ALIEN_DEAD)
-				{
-					x = game.aliens[i].x + xi;
-					y = game.aliens[i].y + yi;
-				}
-			}
-			lastAlien = true;
-			alienMoveDir = 5;
+			std::this_thread::sleep_for(std::chrono::duration<double>(tick_clock_wait(loop.clock)));
+			continue;
 		}
 
-		if (lastAlien) {
-			cout << game.width << endl;
-			if ((x + xi >= game.width) || (x + xi <= 0)) {
-				alienMoveDir *= -1;
-				yi -= 5;
-			}
+		// Draw alpha of the way from the previous tick to the current one
+		SimulationView view = sim.view(tick_clock_alpha(loop.clock));
+
+		// The game is drawn at its own resolution, straight into the frame
+		// or into the draw list for the tiled rasterizer
+		Frame* frame = triple_buffer_back(thread->frames);
+		Buffer buffer;
+		buffer.width = thread->width;
+		buffer.height = thread->height;
+		buffer.data = thread->draws ? NULL : frame->buffer.data;
+		buffer.dirty = thread->atlas ? NULL : thread->dirty;
+		buffer.draws = thread->draws;
+
+		ScopedPhase phase(timers, PHASE_CLEAR);
+		if (buffer.draws) draw_list_clear(buffer.draws);
+		if (buffer.dirty) dirty_begin_frame(buffer.dirty);
+		buffer_clear(&buffer, clear_color);
+
+		// Draw
+		phase.next(PHASE_HUD);
+		size_t text_end = buffer_draw_text(&buffer, glyphs, "SCORE", 5, buffer.height - 15, rgb_to_uint32(128, 0, 0));
+		buffer_draw_number(&buffer, glyphs, sim.game.score, text_end + 5, buffer.height - 15, rgb_to_uint32(128, 0, 0));
+
+		for (int i = 0; i < game.player.life; i++) {
+			const Sprite& life_sprite = glyphs.life_sprite;
+			buffer_draw_sprite(&buffer, life_sprite, (buffer.width - 15 - i * (life_sprite.width + 2)), buffer.height - 15, rgb_to_uint32(128, 0, 0));
 		}
-		xi += alienMoveDir;
 
-		// Check for alien x player
-		for (size_t bi = 0; bi < game.num_aliens; bi++)
+		phase.next(PHASE_ALIEN_DRAW);
+		const AlienArray& aliens = game.aliens;
+		for (size_t ai = 0; ai < aliens.count; ++ai)
 		{
-			if (game.aliens[bi].type != ALIEN_DEAD) {
-				const Player& player = game.player;
-				const SpriteAnimation& animation = alien_animation[game.aliens[bi].type - 1];
-				size_t current_frame = animation.time / animation.frame_duration;
-				const Sprite& alien_sprite = *animation.frames[current_frame];
-
-				bool overlap = sprite_overlap_check(
-					alien_sprite, game.aliens[bi].x + xi, game.aliens[bi].y + yi,
-					player_sprite, player.x, player.y);
-
-				if (overlap)
-				{
-					game.player.life = 0;
-					cout << "te peguei" << endl;
-					continue;
-				}
-				continue;
+			if (alien_alive(aliens, ai))
+			{
+				buffer_draw_sprite(&buffer, sim.alien_sprite(aliens.type[ai]), aliens.x[ai] + view.xi / 2, aliens.y[ai] + view.yi, rgb_to_uint32(128, 0, 0));
+			}
+			else if (aliens.death_counters[ai])
+			{
+				buffer_draw_sprite(&buffer, sprites.alien_death_sprite, aliens.x[ai] + view.xi / 2, aliens.y[ai] + view.yi, rgb_to_uint32(128, 0, 0));
 			}
 		}
-	}
-
-    glfwDestroyWindow(window);
-    glfwTerminate();
-
-    glDeleteVertexArrays(1, &fullscreen_triangle_vao);
-
-    for (size_t i = 0; i < 6; ++i)
-    {
-        delete[] alien_sprites[i].data;
-    }
-
-    delete[] alien_death_sprite.data;
-
-    for (size_t i = 0; i < 3; ++i)
-    {
-        delete[] alien_animation[i].frames;
-    }
-    delete[] buffer.data;
-    delete[] game.aliens;
-    delete[] death_counters;
-
-    return 0;
-}
 
-bool sprite_overlap_check(const Sprite& sp_a, size_t x_a, size_t y_a, const Sprite& sp_b, size_t x_b, size_t y_b)
-{
-	// NOTE: For simplicity we just check for overlap of the sprite
-	// rectangles. Instead, if the rectangles overlap, we should
-	// further check if any pixel of sprite A overlap with any of
-	// sprite B.
-	if (x_a < x_b + sp_b.width && x_a + sp_a.width > x_b &&
-		y_a < y_b + sp_b.height && y_a + sp_a.height > y_b)
-	{
-		return true;
-	}
+		phase.next(PHASE_BULLET_DRAW);
+		const BulletArray& bullets = game.bullets;
+		for (size_t bi = 0; bi < bullets.count; ++bi)
+		{
+			const Sprite& sprite = sprites.bullet_sprite;
+			size_t y;
+			if (bullet_from_alien(bullets, bi)) y = bullets.y[bi] - view.bullet_dy + view.yi;
+			else y = bullets.y[bi] + view.bullet_dy;
+			buffer_draw_sprite(&buffer, sprite, bullets.x[bi], y, rgb_to_uint32(128, 0, 0));
+		}
 
-	return false;
-}
+		buffer_draw_sprite(&buffer, sprites.player_sprite, view.player_x, game.player.y, rgb_to_uint32(128, 0, 0));
 
-uint32_t rgb_to_uint32(uint8_t r, uint8_t g, uint8_t b) {
-	return (r << 24) | (g << 16) | (b << 8) | 255;
-}
+		if (show_timers)
+		{
+			phase.next(PHASE_HUD);
+			buffer_draw_phase_timers(&buffer, glyphs, timers, 5, buffer.height - 22, rgb_to_uint32(255, 255, 255), rgb_to_uint32(0, 0, 0));
+		}
 
-void buffer_clear(Buffer* buffer, uint32_t color) {
-	for (size_t i = 0; i < buffer->width * buffer->height; ++i)
-	{
-		buffer->data[i] = color;
-	}
-}
+		if (thread->rasterizer)
+		{
+			phase.next(PHASE_RASTER);
+			tile_raster_draw(thread->rasterizer, buffer.draws, frame->buffer.data);
+		}
+		else if (thread->atlas)
+		{
+			phase.next(PHASE_RASTER);
+			frame->num_instances = sprite_atlas_instances(*thread->atlas, buffer.draws, frame->instances);
+		}
+		phase.stop();
 
-void buffer_draw_sprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t color)
-{
-	for (size_t xi = 0; xi < sprite.width; ++xi)
-	{
-		for (size_t yi = 0; yi < sprite.height; ++yi)
+		// The rectangles are relative to the frame published before this
+		// one, which is what the texture holds unless the GL thread skipped it
+		if (buffer.dirty)
 		{
-			if (sprite.data[yi * sprite.width + xi] &&
-				(sprite.height - 1 + y - yi) < buffer->height &&
-				(x + xi) < buffer->width)
+			dirty_end_frame(buffer.dirty, buffer.width, buffer.height);
+			for (size_t r = 0; r < buffer.dirty->num_rects; ++r)
 			{
-				buffer->data[(sprite.height - 1 + y - yi) * buffer->width + (x + xi)] = color;
+				const DirtyRect& rect = buffer.dirty->rects[r];
+				DirtyRect& scaled = frame->rects[r];
+				scaled.x = rect.x * thread->scale;
+				scaled.y = rect.y * thread->scale;
+				scaled.width = rect.width * thread->scale;
+				scaled.height = rect.height * thread->scale;
 			}
+			frame->num_rects = buffer.dirty->num_rects;
 		}
+		frame->sequence = ++sequence;
+		frame->brightness = loop.brightness;
+		triple_buffer_publish(thread->frames);
+
+		phase_timers_end_frame(timers);
 	}
 }
 
@@ -574,6 +609,8 @@ Buffer CreateBuffer() {
 	buffer.width = buffer_width;
 	buffer.height = buffer_height;
 	buffer.data = new uint32_t[buffer.width * buffer.height];
+	buffer.dirty = NULL;
+	buffer.draws = NULL;
 	return buffer;
 }
 
@@ -587,335 +624,7 @@ void CreateTexture(GLuint &buffer_texture, Buffer buffer) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 }
 
-Sprite* CreateAlienSprites() {
-    Sprite* alien_sprites = new Sprite[6];
-
-	alien_sprites[0].width = 8;
-	alien_sprites[0].height = 8;
-	alien_sprites[0].data = new uint8_t[64]
-	{
-		0,0,0,1,1,0,0,0, // ...@@...
-		0,0,1,1,1,1,0,0, // ..@@@@..
-		0,1,1,1,1,1,1,0, // .@@@@@@.
-		1,1,0,1,1,0,1,1, // @@.@@.@@
-		1,1,1,1,1,1,1,1, // @@@@@@@@
-		0,1,0,1,1,0,1,0, // .@.@@.@.
-		1,0,0,0,0,0,0,1, // @......@
-		0,1,0,0,0,0,1,0  // .@....@.
-	};
-
-	alien_sprites[1].width = 8;
-	alien_sprites[1].height = 8;
-	alien_sprites[1].data = new uint8_t[64]
-	{
-		0,0,0,1,1,0,0,0, // ...@@...
-		0,0,1,1,1,1,0,0, // ..@@@@..
-		0,1,1,1,1,1,1,0, // .@@@@@@.
-		1,1,0,1,1,0,1,1, // @@.@@.@@
-		1,1,1,1,1,1,1,1, // @@@@@@@@
-		0,0,1,0,0,1,0,0, // ..@..@..
-		0,1,0,1,1,0,1,0, // .@.@@.@.
-		1,0,1,0,0,1,0,1  // @.@..@.@
-	};
-
-	alien_sprites[2].width = 11;
-	alien_sprites[2].height = 8;
-	alien_sprites[2].data = new uint8_t[88]
-	{
-		0,0,1,0,0,0,0,0,1,0,0, // ..@.....@..
-		0,0,0,1,0,0,0,1,0,0,0, // ...@...@...
-		0,0,1,1,1,1,1,1,1,0,0, // ..@@@@@@@..
-		0,1,1,0,1,1,1,0,1,1,0, // .@@.@@@.@@.
-		1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-		1,0,1,1,1,1,1,1,1,0,1, // @.@@@@@@@.@
-		1,0,1,0,0,0,0,0,1,0,1, // @.@.....@.@
-		0,0,0,1,1,0,1,1,0,0,0  // ...@@.@@...
-	};
-
-	alien_sprites[3].width = 11;
-	alien_sprites[3].height = 8;
-	alien_sprites[3].data = new uint8_t[88]
-	{
-		0,0,1,0,0,0,0,0,1,0,0, // ..@.....@..
-		1,0,0,1,0,0,0,1,0,0,1, // @..@...@..@
-		1,0,1,1,1,1,1,1,1,0,1, // @.@@@@@@@.@
-		1,1,1,0,1,1,1,0,1,1,1, // @@@.@@@.@@@
-		1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-		0,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@.
-		0,0,1,0,0,0,0,0,1,0,0, // ..@.....@..
-		0,1,0,0,0,0,0,0,0,1,0  // .@.......@.
-	};
-
-	alien_sprites[4].width = 12;
-	alien_sprites[4].height = 8;
-	alien_sprites[4].data = new uint8_t[96]
-	{
-		0,0,0,0,1,1,1,1,0,0,0,0, // ....@@@@....
-		0,1,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@@.
-		1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-		1,1,1,0,0,1,1,0,0,1,1,1, // @@@..@@..@@@
-		1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-		0,0,0,1,1,0,0,1,1,0,0,0, // ...@@..@@...
-		0,0,1,1,0,1,1,0,1,1,0,0, // ..@@.@@.@@..
-		1,1,0,0,0,0,0,0,0,0,1,1  // @@........@@
-	};
-
-
-	alien_sprites[5].width = 12;
-	alien_sprites[5].height = 8;
-	alien_sprites[5].data = new uint8_t[96]
-	{
-		0,0,0,0,1,1,1,1,0,0,0,0, // ....@@@@....
-		0,1,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@@.
-		1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-		1,1,1,0,0,1,1,0,0,1,1,1, // @@@..@@..@@@
-		1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-		0,0,1,1,1,0,0,1,1,1,0,0, // ..@@@..@@@..
-		0,1,1,0,0,1,1,0,0,1,1,0, // .@@..@@..@@.
-		0,0,1,1,0,0,0,0,1,1,0,0  // ..@@....@@..
-	};
-
-	return alien_sprites;
-}
-
-Sprite CreateDeathSprite() {
-	Sprite alien_death_sprite;
-	alien_death_sprite.width = 13;
-	alien_death_sprite.height = 7;
-	alien_death_sprite.data = new uint8_t[91]
-	{
-		0,1,0,0,1,0,0,0,1,0,0,1,0, // .@..@...@..@.
-		0,0,1,0,0,1,0,1,0,0,1,0,0, // ..@..@.@..@..
-		0,0,0,1,0,0,0,0,0,1,0,0,0, // ...@.....@...
-		1,1,0,0,0,0,0,0,0,0,0,1,1, // @@.........@@
-		0,0,0,1,0,0,0,0,0,1,0,0,0, // ...@.....@...
-		0,0,1,0,0,1,0,1,0,0,1,0,0, // ..@..@.@..@..
-		0,1,0,0,1,0,0,0,1,0,0,1,0  // .@..@...@..@.
-	};
-	return alien_death_sprite;
-}
-
-Sprite CreatePlayer() {
-	Sprite player_sprite;
-	player_sprite.width = 11;
-	player_sprite.height = 7;
-	player_sprite.data = new uint8_t[player_sprite.width * player_sprite.height]
-	{
-		0,0,0,0,0,1,0,0,0,0,0, // .....@.....
-		0,0,0,0,1,1,1,0,0,0,0, // ....@@@....
-		0,0,0,0,1,1,1,0,0,0,0, // ....@@@....
-		0,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@.
-		1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-		1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-		1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-	};
-	return player_sprite;
-}
-
-Sprite CreateTextSprite(char letter) {
-	Sprite textSprite;
-	textSprite.width = 4;
-	textSprite.height = 5;
-	switch (letter) {
-		case 'S':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				0, 1, 1, 1,
-				1, 0, 0, 0,
-				0, 1, 1, 0,
-				0, 0, 0, 1,
-				1, 1, 1, 0
-			};
-		break;
-		
-		case 'C':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				0, 1, 1, 1,
-				1, 0, 0, 0,
-				1, 0, 0, 0,
-				1, 0, 0, 0,
-				0, 1, 1, 1
-			};
-		break;
-
-		case 'O':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				0, 1, 1, 0,
-				1, 0, 0, 1,
-				1, 0, 0, 1,
-				1, 0, 0, 1,
-				0, 1, 1, 0
-			};
-		break;
-
-		case 'R':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				1, 0, 0, 1,
-				1, 1, 1, 0,
-				1, 0, 1, 0,
-				1, 0, 0, 1
-			};
-		break;
-
-		case 'E':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 1,
-				1, 0, 0, 0,
-				1, 1, 1, 0,
-				1, 0, 0, 0,
-				1, 1, 1, 1
-			};
-		break;
-
-		case '0':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				1, 0, 1, 0,
-				1, 0, 1, 0,
-				1, 0, 1, 0,
-				1, 1, 1, 0
-			};
-		break;
-
-		case '1':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				0, 1, 0, 0,
-				0, 1, 0, 0,
-				0, 1, 0, 0,
-				0, 1, 0, 0,
-				0, 1, 0, 0
-			};
-		break;
-
-		case '2':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				0, 0, 1, 0,
-				1, 1, 0, 0,
-				1, 0, 0, 0,
-				1, 1, 1, 0
-			};
-		break;
-
-		case '3':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				0, 0, 1, 0,
-				0, 1, 0, 0,
-				0, 0, 1, 0,
-				1, 1, 1, 0
-			};
-		break;
-
-		case '4':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 0, 1, 0,
-				1, 0, 1, 0,
-				1, 1, 1, 0,
-				0, 0, 1, 0,
-				0, 0, 1, 0
-			};
-			break;
-
-		case '5':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				0, 1, 1, 1,
-				0, 1, 0, 0,
-				0, 1, 1, 0,
-				0, 0, 0, 1,
-				0, 1, 1, 0
-			};
-			break;
-
-		case '6':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				1, 0, 0, 0,
-				1, 1, 1, 0,
-				1, 0, 1, 0,
-				1, 1, 1, 0
-			};
-			break;
-
-		case '7':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				0, 0, 1, 0,
-				0, 0, 1, 0,
-				0, 0, 1, 0,
-				0, 0, 1, 0
-			};
-			break;
-
-		case '8':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				1, 0, 1, 0,
-				1, 1, 1, 0,
-				1, 0, 1, 0,
-				1, 1, 1, 0
-			};
-			break;
-
-		case '9':
-			textSprite.data = new uint8_t[textSprite.width * textSprite.height]{
-				1, 1, 1, 0,
-				1, 0, 1, 0,
-				1, 1, 1, 0,
-				0, 0, 1, 0,
-				0, 0, 1, 0
-			};
-			break;
-	}
-
-	return textSprite;
-}
-
-Game CreateGame() {
-	Game game;
-	game.width = buffer_width;
-	game.height = buffer_height;
-	game.num_bullets = 0;
-	game.num_aliens = 55;
-	game.aliens = new Alien[game.num_aliens];
-
-	game.player.x = 112 - 5;
-	game.player.y = 32;
 
-	game.player.life = 3;
-	return game;
-}
-
-Sprite CreateBullet() {
-	Sprite bullet_sprite;
-	bullet_sprite.width = 1;
-	bullet_sprite.height = 3;
-	bullet_sprite.data = new uint8_t[3]
-	{
-		1, // @
-		1, // @
-		1  // @
-	};
-	return bullet_sprite;
-}
-
-SpriteAnimation* CreateAnimation(Sprite* alien_sprites) {
-	SpriteAnimation * alien_animation = new SpriteAnimation[3];
-
-	for (size_t i = 0; i < 3; ++i)
-	{
-		alien_animation[i].loop = true;
-		alien_animation[i].num_frames = 2;
-		alien_animation[i].frame_duration = 10;
-		alien_animation[i].time = 0;
-
-		alien_animation[i].frames = new Sprite * [2];
-		alien_animation[i].frames[0] = &alien_sprites[2 * i];
-		alien_animation[i].frames[1] = &alien_sprites[2 * i + 1];
-	};
-
-	return alien_animation;
-}
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
 	switch (key) {
@@ -923,15 +632,22 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		if (action == GLFW_PRESS) game_running = false;
 		break;
 	case GLFW_KEY_RIGHT:
-		if (action == GLFW_PRESS) move_dir += 1;
-		else if (action == GLFW_RELEASE) move_dir -= 1;
+		if (action == GLFW_PRESS) controls.move_dir += 1;
+		else if (action == GLFW_RELEASE) controls.move_dir -= 1;
 		break;
 	case GLFW_KEY_LEFT:
-		if (action == GLFW_PRESS) move_dir -= 1;
-		else if (action == GLFW_RELEASE) move_dir += 1;
+		if (action == GLFW_PRESS) controls.move_dir -= 1;
+		else if (action == GLFW_RELEASE) controls.move_dir += 1;
 		break;
 	case GLFW_KEY_SPACE:
-		if (action == GLFW_RELEASE) fire_pressed = true;
+		if (action == GLFW_RELEASE) controls.fire_pressed = true;
+		break;
+	case GLFW_KEY_BACKSPACE:
+		if (action == GLFW_PRESS) controls.rewind_held = true;
+		else if (action == GLFW_RELEASE) controls.rewind_held = false;
+		break;
+	case GLFW_KEY_F3:
+		if (action == GLFW_PRESS) show_timers = !show_timers.load();
 		break;
 	default:
 		break;
@@ -0,0 +1,66 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool MapFile(const char* path, MappedFile* file) {
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	CloseHandle(handle);
+	if (!mapping) return false;
+
+	// The view keeps the mapping alive
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!view) return false;
+
+	file->bytes = static_cast<const uint8_t*>(view);
+	file->size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void UnmapFile(MappedFile* file) {
+	UnmapViewOfFile(file->bytes);
+	file->bytes = NULL;
+	file->size = 0;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MapFile(const char* path, MappedFile* file) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	void* view = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		view = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	// The mapping keeps the file open
+	close(fd);
+	if (view == MAP_FAILED) return false;
+
+	file->bytes = static_cast<const uint8_t*>(view);
+	file->size = static_cast<size_t>(st.st_size);
+	return true;
+}
+
+void UnmapFile(MappedFile* file) {
+	munmap(const_cast<uint8_t*>(file->bytes), file->size);
+	file->bytes = NULL;
+	file->size = 0;
+}
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// A whole file mapped read-only. Pages are only read from disk when they
+// are first touched, so a large file costs nothing up front
+struct MappedFile
+{
+	const uint8_t* bytes;
+	size_t size;
+};
+
+// Returns false, with nothing to unmap, when the file is missing or empty
+bool MapFile(const char* path, MappedFile* file);
+void UnmapFile(MappedFile* file);
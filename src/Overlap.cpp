@@ -0,0 +1,107 @@
+#include <algorithm>
+#include "Bits.h"
+#include "Overlap.h"
+
+#ifdef OVERLAP_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+void overlap_translate_scalar(int16_t* dst, const int16_t* src, size_t count, float offset)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		float v = std::min(std::max(src[i] + offset, float(INT16_MIN)), float(INT16_MAX));
+		dst[i] = static_cast<int16_t>(v);
+	}
+}
+
+// Every coordinate fits in 16 bits, so wrapping there gives the same
+// answers as wrapping in size_t
+static inline bool overlap_one(const OverlapBatch& batch, size_t i, uint16_t ax, uint16_t ay, uint16_t ax_end, uint16_t ay_end)
+{
+	uint16_t bx = static_cast<uint16_t>(batch.x[i]), by = static_cast<uint16_t>(batch.y[i]);
+	return ax < uint16_t(bx + batch.width[i]) && bx < ax_end &&
+		ay < uint16_t(by + batch.height[i]) && by < ay_end;
+}
+
+uint64_t overlap_mask_scalar(const OverlapBatch& batch, size_t x, size_t y, size_t width, size_t height)
+{
+	uint16_t ax = static_cast<uint16_t>(x), ay = static_cast<uint16_t>(y);
+	uint16_t ax_end = static_cast<uint16_t>(x + width), ay_end = static_cast<uint16_t>(y + height);
+
+	uint64_t mask = 0;
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		if (overlap_one(batch, i, ax, ay, ax_end, ay_end)) mask |= uint64_t(1) << i;
+	}
+	return mask;
+}
+
+uint64_t overlap_mask_subset(const OverlapBatch& batch, uint64_t subset, size_t x, size_t y, size_t width, size_t height)
+{
+	uint16_t ax = static_cast<uint16_t>(x), ay = static_cast<uint16_t>(y);
+	uint16_t ax_end = static_cast<uint16_t>(x + width), ay_end = static_cast<uint16_t>(y + height);
+
+	uint64_t mask = 0;
+	for (; subset; subset &= subset - 1)
+	{
+		size_t i = count_trailing_zeros64(subset);
+		if (overlap_one(batch, i, ax, ay, ax_end, ay_end)) mask |= uint64_t(1) << i;
+	}
+	return mask;
+}
+
+#ifdef OVERLAP_HAS_SSE2
+void overlap_translate_sse2(int16_t* dst, const int16_t* src, size_t count, float offset)
+{
+	__m128 v_offset = _mm_set1_ps(offset);
+	for (size_t i = 0; i < count; i += OVERLAP_LANES)
+	{
+		// Sign extend to 32 bits, translate in float, then pack back down
+		// with signed saturation
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		lo = _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(lo), v_offset));
+		hi = _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(hi), v_offset));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+	}
+}
+
+// SSE2 only compares signed integers, flipping the sign bit of both sides
+// turns that into an unsigned compare
+static inline __m128i flip_sign_epi16(__m128i v)
+{
+	return _mm_xor_si128(v, _mm_set1_epi16(INT16_MIN));
+}
+
+uint64_t overlap_mask_sse2(const OverlapBatch& batch, size_t x, size_t y, size_t width, size_t height)
+{
+	__m128i ax = flip_sign_epi16(_mm_set1_epi16(static_cast<short>(x)));
+	__m128i ay = flip_sign_epi16(_mm_set1_epi16(static_cast<short>(y)));
+	__m128i ax_end = flip_sign_epi16(_mm_set1_epi16(static_cast<short>(x + width)));
+	__m128i ay_end = flip_sign_epi16(_mm_set1_epi16(static_cast<short>(y + height)));
+
+	uint64_t mask = 0;
+	for (size_t i = 0; i < batch.count; i += OVERLAP_LANES)
+	{
+		__m128i bx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.x + i));
+		__m128i by = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.y + i));
+		__m128i bw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.width + i));
+		__m128i bh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.height + i));
+
+		// Eight rectangles per pass, as in sprite_overlap_check
+		__m128i hit = _mm_cmplt_epi16(ax, flip_sign_epi16(_mm_add_epi16(bx, bw)));
+		hit = _mm_and_si128(hit, _mm_cmplt_epi16(flip_sign_epi16(bx), ax_end));
+		hit = _mm_and_si128(hit, _mm_cmplt_epi16(ay, flip_sign_epi16(_mm_add_epi16(by, bh))));
+		hit = _mm_and_si128(hit, _mm_cmplt_epi16(flip_sign_epi16(by), ay_end));
+
+		// One byte per lane, then one bit per byte
+		int bits = _mm_movemask_epi8(_mm_packs_epi16(hit, _mm_setzero_si128()));
+		mask |= uint64_t(bits) << i;
+	}
+
+	if (batch.count < 64) mask &= (uint64_t(1) << batch.count) - 1;
+	return mask;
+}
+#endif
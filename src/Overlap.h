@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Up to 64 rectangles as parallel arrays, like the AlienArray positions.
+// The kernels work on groups of OVERLAP_LANES rectangles, so the arrays
+// must hold count rounded up to a multiple of it; the extra entries are
+// read but never reported
+#define OVERLAP_LANES 8
+
+struct OverlapBatch
+{
+	const int16_t* x;
+	const int16_t* y;
+	const int16_t* width;
+	const int16_t* height;
+	size_t count;
+};
+
+// dst[i] = src[i] + offset, computed in float and truncated toward zero
+// like the float to size_t conversions the formation offset used to go
+// through. Results saturate to the int16 range. Both arrays are padded
+// like the OverlapBatch ones
+void overlap_translate_scalar(int16_t* dst, const int16_t* src, size_t count, float offset);
+
+// Tests the rectangle [x, x + width) x [y, y + height) against every
+// rectangle of the batch and returns a mask with bit i set when rectangle
+// i overlaps it. Coordinates wrap like the size_t arithmetic of
+// sprite_overlap_check, so a rectangle at a negative position never
+// overlaps one near the origin
+uint64_t overlap_mask_scalar(const OverlapBatch& batch, size_t x, size_t y, size_t width, size_t height);
+
+// Same, testing only the rectangles whose bit is set in subset, one at a
+// time. Cheaper than the whole batch when a few are left to test
+uint64_t overlap_mask_subset(const OverlapBatch& batch, uint64_t subset, size_t x, size_t y, size_t width, size_t height);
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_IX86)
+#define OVERLAP_HAS_SSE2 1
+void overlap_translate_sse2(int16_t* dst, const int16_t* src, size_t count, float offset);
+uint64_t overlap_mask_sse2(const OverlapBatch& batch, size_t x, size_t y, size_t width, size_t height);
+#endif
+
+// SSE2 is part of every x86-64 CPU, so these are picked at compile time
+inline void overlap_translate(int16_t* dst, const int16_t* src, size_t count, float offset)
+{
+#ifdef OVERLAP_HAS_SSE2
+	overlap_translate_sse2(dst, src, count, offset);
+#else
+	overlap_translate_scalar(dst, src, count, offset);
+#endif
+}
+
+inline uint64_t overlap_mask(const OverlapBatch& batch, size_t x, size_t y, size_t width, size_t height)
+{
+#ifdef OVERLAP_HAS_SSE2
+	return overlap_mask_sse2(batch, x, y, width, height);
+#else
+	return overlap_mask_scalar(batch, x, y, width, height);
+#endif
+}
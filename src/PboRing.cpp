@@ -0,0 +1,108 @@
+#include "PboRing.h"
+#include "Trace.h"
+
+PboRing* CreatePboRing(size_t width, size_t height) {
+	PboRing* ring = new PboRing;
+	ring->size = width * height * sizeof(uint32_t);
+	ring->current = 0;
+	ring->persistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+
+	glGenBuffers(PBO_RING_SIZE, ring->buffers);
+	for (size_t i = 0; i < PBO_RING_SIZE; ++i)
+	{
+		ring->fences[i] = NULL;
+		ring->mapped[i] = NULL;
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffers[i]);
+		if (ring->persistent)
+		{
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER, ring->size, NULL, flags);
+			ring->mapped[i] = static_cast<uint32_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ring->size, flags));
+		}
+		else
+		{
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, ring->size, NULL, GL_STREAM_DRAW);
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	return ring;
+}
+
+void DestroyPboRing(PboRing* ring) {
+	for (size_t i = 0; i < PBO_RING_SIZE; ++i)
+	{
+		if (ring->fences[i]) glDeleteSync(ring->fences[i]);
+		if (ring->mapped[i])
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffers[i]);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glDeleteBuffers(PBO_RING_SIZE, ring->buffers);
+	delete ring;
+}
+
+uint32_t* pbo_ring_begin_frame(PboRing* ring)
+{
+	size_t i = ring->current;
+
+	if (ring->persistent)
+	{
+		// The copy queued PBO_RING_SIZE frames ago may still be reading
+		// this buffer. It normally finished long ago, so this rarely waits
+		if (ring->fences[i])
+		{
+			ScopedTrace trace("glClientWaitSync");
+			glClientWaitSync(ring->fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(ring->fences[i]);
+			ring->fences[i] = NULL;
+		}
+		return ring->mapped[i];
+	}
+
+	// Orphan the old storage so mapping never waits on a pending copy
+	ScopedTrace trace("glMapBufferRange");
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffers[i]);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, ring->size, NULL, GL_STREAM_DRAW);
+	ring->mapped[i] = static_cast<uint32_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ring->size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	return ring->mapped[i];
+}
+
+void pbo_ring_upload(PboRing* ring, const Buffer& buffer, const DirtyRect* rects, size_t num_rects)
+{
+	size_t i = ring->current;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffers[i]);
+	if (!ring->persistent)
+	{
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		ring->mapped[i] = NULL;
+	}
+
+	// With a buffer bound the data pointer is a byte offset into it
+	for (size_t r = 0; r < num_rects; ++r)
+	{
+		const DirtyRect& rect = rects[r];
+		ScopedTrace trace("glTexSubImage2D");
+		size_t offset = (rect.y * buffer.width + rect.x) * sizeof(uint32_t);
+		glTexSubImage2D(
+			GL_TEXTURE_2D, 0, rect.x, rect.y,
+			rect.width, rect.height,
+			GL_RGBA, GL_UNSIGNED_INT_8_8_8_8,
+			reinterpret_cast<const void*>(offset)
+		);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (ring->persistent)
+	{
+		ring->fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	ring->current = (i + 1) % PBO_RING_SIZE;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <GL/glew.h>
+#include "Items.h"
+#include "Dirty.h"
+
+#define PBO_RING_SIZE 3
+
+// Ring of pixel buffer objects the GL thread copies the changed regions
+// of each frame into. Uploading a frame only queues a copy from the buffer
+// object to the texture, which the driver performs while the CPU moves on.
+// With GL_ARB_buffer_storage every buffer stays persistently mapped and a
+// fence keeps the CPU from writing a frame the GPU is still reading;
+// otherwise each frame orphans its buffer and maps the fresh storage
+struct PboRing
+{
+	GLuint buffers[PBO_RING_SIZE];
+	GLsync fences[PBO_RING_SIZE];
+	uint32_t* mapped[PBO_RING_SIZE];
+	size_t size;
+	size_t current;
+	bool persistent;
+};
+
+PboRing* CreatePboRing(size_t width, size_t height);
+void DestroyPboRing(PboRing* ring);
+
+// Returns the pixels to write the next frame into
+uint32_t* pbo_ring_begin_frame(PboRing* ring);
+// Copies the given regions of the frame to the currently bound texture
+void pbo_ring_upload(PboRing* ring, const Buffer& buffer, const DirtyRect* rects, size_t num_rects);
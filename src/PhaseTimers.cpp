@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cstdio>
+#include "PhaseTimers.h"
+
+static const struct
+{
+	const char* name;
+	const char* label;
+} phase_names[PHASE_COUNT] = {
+	{ "clear", "CLEAR" },
+	{ "hud", "HUD" },
+	{ "alien_draw", "ALIENS" },
+	{ "bullet_draw", "BULLETS" },
+	{ "raster", "RASTER" },
+	{ "upload", "UPLOAD" },
+	{ "swap", "SWAP" },
+	{ "bullet_sim", "SHOTS" },
+	{ "player_sim", "PLAYER" },
+	{ "alien_march", "MARCH" },
+	{ "collision", "HITS" },
+	{ "frame", "FRAME" }
+};
+
+PhaseTimers* CreatePhaseTimers(const char* name) {
+	PhaseTimers* timers = new PhaseTimers();
+	timers->name = name;
+	timers->last_frame_end = PhaseClock::now();
+	return timers;
+}
+
+const char* phase_name(Phase phase)
+{
+	return phase_names[phase].name;
+}
+
+const char* phase_label(Phase phase)
+{
+	return phase_names[phase].label;
+}
+
+void phase_timers_end_frame(PhaseTimers* timers)
+{
+	PhaseClock::time_point now = PhaseClock::now();
+	timers->current[PHASE_FRAME] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - timers->last_frame_end).count();
+	if (trace_ring) trace_complete(trace_ring, phase_name(PHASE_FRAME), timers->last_frame_end, now);
+	timers->last_frame_end = now;
+	timers->recorded |= 1u << PHASE_FRAME;
+	timers->timed |= 1u << PHASE_FRAME;
+
+	for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+	{
+		if (!((timers->timed >> phase) & 1)) continue;
+		size_t slot = timers->num_samples[phase]++ % PHASE_TIMER_HISTORY;
+		timers->samples[phase][slot] = static_cast<uint32_t>(std::min<uint64_t>(timers->current[phase], UINT32_MAX));
+		timers->current[phase] = 0;
+	}
+	timers->timed = 0;
+	++timers->frames;
+}
+
+PhaseStats phase_timers_stats(const PhaseTimers* timers, Phase phase)
+{
+	PhaseStats stats = { 0, 0, 0 };
+	size_t count = phase_timers_window(timers, phase);
+	if (!count) return stats;
+
+	uint32_t sorted[PHASE_TIMER_HISTORY];
+	std::copy(timers->samples[phase], timers->samples[phase] + count, sorted);
+
+	uint64_t sum = 0;
+	uint32_t min = UINT32_MAX;
+	for (size_t i = 0; i < count; ++i)
+	{
+		sum += sorted[i];
+		min = std::min(min, sorted[i]);
+	}
+
+	// Nearest rank: the smallest sample with at least 99% of them at or below it
+	size_t rank = (count * 99 + 99) / 100 - 1;
+	std::nth_element(sorted, sorted + rank, sorted + count);
+
+	stats.min_us = min / 1e3;
+	stats.avg_us = sum / 1e3 / count;
+	stats.p99_us = sorted[rank] / 1e3;
+	return stats;
+}
+
+bool phase_timers_write_csv(const PhaseTimers* const* timers, size_t num_timers, const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file) return false;
+
+	fprintf(file, "thread,phase,frames,min_us,avg_us,p99_us\n");
+	for (size_t t = 0; t < num_timers; ++t)
+	{
+		for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+		{
+			if (!phase_timers_recorded(timers[t], static_cast<Phase>(phase))) continue;
+			PhaseStats stats = phase_timers_stats(timers[t], static_cast<Phase>(phase));
+			fprintf(file, "%s,%s,%zu,%.3f,%.3f,%.3f\n", timers[t]->name, phase_name(static_cast<Phase>(phase)),
+				phase_timers_window(timers[t], static_cast<Phase>(phase)), stats.min_us, stats.avg_us, stats.p99_us);
+		}
+	}
+
+	return fclose(file) == 0;
+}
+
+bool phase_timers_write_json(const PhaseTimers* const* timers, size_t num_timers, const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file) return false;
+
+	fprintf(file, "{\n  \"threads\": [\n");
+	for (size_t t = 0; t < num_timers; ++t)
+	{
+		size_t count = std::min<size_t>(timers[t]->frames, PHASE_TIMER_HISTORY);
+		fprintf(file, "    {\n      \"name\": \"%s\",\n      \"total_frames\": %zu,\n      \"window_frames\": %zu,\n      \"phases\": [",
+			timers[t]->name, timers[t]->frames, count);
+		const char* separator = "\n";
+		for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+		{
+			if (!phase_timers_recorded(timers[t], static_cast<Phase>(phase))) continue;
+			PhaseStats stats = phase_timers_stats(timers[t], static_cast<Phase>(phase));
+			fprintf(file, "%s        { \"phase\": \"%s\", \"frames\": %zu, \"min_us\": %.3f, \"avg_us\": %.3f, \"p99_us\": %.3f }",
+				separator, phase_name(static_cast<Phase>(phase)), phase_timers_window(timers[t], static_cast<Phase>(phase)), stats.min_us, stats.avg_us, stats.p99_us);
+			separator = ",\n";
+		}
+		fprintf(file, "\n      ]\n    }%s\n", t + 1 < num_timers ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+
+	return fclose(file) == 0;
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "Trace.h"
+
+// Phases of a frame. The drawing ones are timed by the simulation thread
+// around its frames, the simulation ones inside Simulation::step, and
+// UPLOAD and SWAP by the GL thread. Each thread has its own PhaseTimers,
+// and PHASE_FRAME is the time from one of its phase_timers_end_frame to
+// the next, so it includes everything that thread does
+enum Phase : uint8_t
+{
+	PHASE_CLEAR,
+	PHASE_HUD,
+	PHASE_ALIEN_DRAW,
+	PHASE_BULLET_DRAW,
+	PHASE_RASTER,
+	PHASE_UPLOAD,
+	PHASE_SWAP,
+	PHASE_BULLET_SIM,
+	PHASE_PLAYER_SIM,
+	PHASE_ALIEN_MARCH,
+	PHASE_COLLISION,
+	PHASE_FRAME,
+	PHASE_COUNT
+};
+
+// Number of frames the rolling statistics cover
+#define PHASE_TIMER_HISTORY 256
+
+struct PhaseTimers
+{
+	// Thread the timers belong to, for the dump files
+	const char* name;
+	// Bit per phase timed at least once, phases of other threads stay unset
+	uint32_t recorded;
+	// Bit per phase timed so far this frame. Frames that did not run a
+	// phase, like those without a simulation tick, add no sample for it
+	uint32_t timed;
+	// Nanoseconds spent in each phase, one slot per frame that timed it
+	uint32_t samples[PHASE_COUNT][PHASE_TIMER_HISTORY];
+	size_t num_samples[PHASE_COUNT];
+	// Time spent in each phase so far this frame
+	uint64_t current[PHASE_COUNT];
+	size_t frames;
+	PhaseClock::time_point last_frame_end;
+};
+
+struct PhaseStats
+{
+	double min_us, avg_us, p99_us;
+};
+
+PhaseTimers* CreatePhaseTimers(const char* name);
+
+// Lowercase name for the dump files, uppercase label for the overlay
+const char* phase_name(Phase phase);
+const char* phase_label(Phase phase);
+
+inline void phase_timers_add(PhaseTimers* timers, Phase phase, PhaseClock::duration elapsed)
+{
+	timers->current[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+	timers->recorded |= 1u << phase;
+	timers->timed |= 1u << phase;
+}
+
+inline bool phase_timers_recorded(const PhaseTimers* timers, Phase phase)
+{
+	return (timers->recorded >> phase) & 1;
+}
+
+// Moves this frame's times into the rolling window. With a trace ring,
+// the frame is recorded there too
+void phase_timers_end_frame(PhaseTimers* timers);
+
+// Statistics over the last PHASE_TIMER_HISTORY frames that timed the
+// phase, or fewer at startup
+PhaseStats phase_timers_stats(const PhaseTimers* timers, Phase phase);
+
+inline size_t phase_timers_window(const PhaseTimers* timers, Phase phase)
+{
+	return timers->num_samples[phase] < PHASE_TIMER_HISTORY ? timers->num_samples[phase] : PHASE_TIMER_HISTORY;
+}
+
+// Both write one entry per thread and phase it recorded, with the rolling
+// statistics, and return false when the file can not be written
+bool phase_timers_write_csv(const PhaseTimers* const* timers, size_t num_timers, const char* path);
+bool phase_timers_write_json(const PhaseTimers* const* timers, size_t num_timers, const char* path);
+
+// Times a phase until it goes out of scope, stop() or next() is called,
+// and records it as a trace event when tracing is on. Does nothing when
+// timers is NULL and there is no trace ring, so it can stay in release
+// builds
+struct ScopedPhase
+{
+	PhaseTimers* timers;
+	Phase phase;
+	bool running;
+	PhaseClock::time_point start;
+
+	ScopedPhase(PhaseTimers* timers, Phase phase) : timers(timers), phase(phase), running(timers || trace_ring)
+	{
+		if (running) start = PhaseClock::now();
+	}
+
+	~ScopedPhase() { stop(); }
+
+	ScopedPhase(const ScopedPhase&) = delete;
+	ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+	void stop()
+	{
+		if (!running) return;
+		end(PhaseClock::now());
+		running = false;
+	}
+
+	// Ends the current phase and starts the next one with a single clock read
+	void next(Phase next_phase)
+	{
+		if (!timers && !trace_ring) return;
+		PhaseClock::time_point now = PhaseClock::now();
+		if (running) end(now);
+		phase = next_phase;
+		start = now;
+		running = true;
+	}
+
+	void end(PhaseClock::time_point now)
+	{
+		if (timers) phase_timers_add(timers, phase, now - start);
+		if (trace_ring) trace_complete(trace_ring, phase_name(phase), start, now);
+	}
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 random numbers (pcg-random.org): 64 bits of state, 32 bit outputs.
+// Each game owns one, so games on different threads never share a
+// generator, and copying a game copies where its random stream is
+struct Random
+{
+	uint64_t state;
+};
+
+#define RANDOM_MULTIPLIER 6364136223846793005ull
+#define RANDOM_INCREMENT 1442695040888963407ull
+
+inline uint32_t random_next(Random& random)
+{
+	uint64_t state = random.state;
+	random.state = state * RANDOM_MULTIPLIER + RANDOM_INCREMENT;
+	uint32_t xorshifted = static_cast<uint32_t>(((state >> 18) ^ state) >> 27);
+	uint32_t rotation = static_cast<uint32_t>(state >> 59);
+	return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+}
+
+inline Random CreateRandom(uint64_t seed)
+{
+	Random random = { 0 };
+	random_next(random);
+	random.state += seed;
+	random_next(random);
+	return random;
+}
+
+// A number in [0, n), n > 0, from the high half of a 32x32 bit multiply
+inline uint32_t random_below(Random& random, uint32_t n)
+{
+	return static_cast<uint32_t>((uint64_t(random_next(random)) * n) >> 32);
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include "Render.h"
+#include "Fill.h"
+#include "Dirty.h"
+#include "TileRaster.h"
+#include "Bits.h"
+
+uint32_t rgb_to_uint32(uint8_t r, uint8_t g, uint8_t b) {
+	return (r << 24) | (g << 16) | (b << 8) | 255;
+}
+
+void buffer_clear(Buffer* buffer, uint32_t color) {
+	if (buffer->dirty) dirty_record(buffer->dirty, NULL, 0, 0, buffer->width, buffer->height, color);
+	if (buffer->draws)
+	{
+		draw_list_add(buffer->draws, NULL, 0, 0, buffer->width, buffer->height, color);
+		return;
+	}
+	fill_u32(buffer->data, buffer->width * buffer->height, color);
+}
+
+void buffer_fill_rect(Buffer* buffer, size_t x, size_t y, size_t width, size_t height, uint32_t color)
+{
+	if (buffer->dirty) dirty_record(buffer->dirty, NULL, x, y, width, height, color);
+	if (buffer->draws)
+	{
+		draw_list_add(buffer->draws, NULL, x, y, width, height, color);
+		return;
+	}
+
+	ptrdiff_t x0 = std::max(static_cast<ptrdiff_t>(x), ptrdiff_t(0));
+	ptrdiff_t y0 = std::max(static_cast<ptrdiff_t>(y), ptrdiff_t(0));
+	ptrdiff_t x1 = std::min(static_cast<ptrdiff_t>(x + width), static_cast<ptrdiff_t>(buffer->width));
+	ptrdiff_t y1 = std::min(static_cast<ptrdiff_t>(y + height), static_cast<ptrdiff_t>(buffer->height));
+	if (x0 >= x1 || y0 >= y1) return;
+
+	// A rectangle spanning full rows is one contiguous fill
+	if (x0 == 0 && x1 == static_cast<ptrdiff_t>(buffer->width))
+	{
+		fill_u32(buffer->data + y0 * buffer->width, (y1 - y0) * buffer->width, color);
+		return;
+	}
+
+	for (ptrdiff_t row = y0; row < y1; ++row)
+	{
+		fill_u32(buffer->data + row * buffer->width + x0, x1 - x0, color);
+	}
+}
+
+void buffer_copy_rects(const Buffer* buffer, uint32_t* dst, const DirtyRect* rects, size_t num_rects)
+{
+	for (size_t r = 0; r < num_rects; ++r)
+	{
+		const DirtyRect& rect = rects[r];
+		for (ptrdiff_t row = rect.y; row < rect.y + rect.height; ++row)
+		{
+			size_t offset = row * buffer->width + rect.x;
+			std::copy(buffer->data + offset, buffer->data + offset + rect.width, dst + offset);
+		}
+	}
+}
+
+// Blits rows [0, H) of a sprite whose top row lands on dst. With the
+// height known at compile time the row loop is fully unrolled
+template <size_t H>
+static void blit_rows(uint32_t* dst, ptrdiff_t stride, const uint32_t* rows, size_t shift, uint32_t span_mask, uint32_t color)
+{
+	for (size_t yi = 0; yi < H; ++yi)
+	{
+		uint32_t mask = (rows[yi] >> shift) & span_mask;
+		while (mask)
+		{
+			dst[count_trailing_zeros(mask)] = color;
+			mask &= mask - 1;
+		}
+		dst -= stride;
+	}
+}
+
+void buffer_draw_sprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t color)
+{
+	// Positions just left of or below the screen arrive wrapped around, so
+	// clip in signed space, once for the whole sprite
+	ptrdiff_t left = static_cast<ptrdiff_t>(x);
+	ptrdiff_t top = static_cast<ptrdiff_t>(y) + static_cast<ptrdiff_t>(sprite.height) - 1;
+	ptrdiff_t buffer_width = static_cast<ptrdiff_t>(buffer->width);
+	ptrdiff_t buffer_height = static_cast<ptrdiff_t>(buffer->height);
+
+	if (buffer->dirty) dirty_record(buffer->dirty, &sprite, left, y, sprite.width, sprite.height, color);
+	if (buffer->draws)
+	{
+		draw_list_add(buffer->draws, &sprite, left, y, sprite.width, sprite.height, color);
+		return;
+	}
+
+	ptrdiff_t x0 = left < 0 ? 0 : left;
+	ptrdiff_t x1 = std::min(left + static_cast<ptrdiff_t>(sprite.width), buffer_width);
+	if (x0 >= x1) return;
+
+	// Sprite row 0 is the top one, drawn on the highest buffer row
+	ptrdiff_t first_row = top >= buffer_height ? top - buffer_height + 1 : 0;
+	ptrdiff_t last_row = std::min(static_cast<ptrdiff_t>(sprite.height), top + 1);
+	if (first_row >= last_row) return;
+
+	size_t shift = x0 - left;
+	size_t span = x1 - x0;
+	uint32_t span_mask = span >= 32 ? ~0u : (1u << span) - 1;
+
+	// Sprites not clipped vertically take a specialized blitter for the
+	// heights of the built in sprites and glyphs
+	if (first_row == 0 && last_row == static_cast<ptrdiff_t>(sprite.height))
+	{
+		uint32_t* top_row = buffer->data + top * buffer_width + x0;
+		switch (sprite.height)
+		{
+		case 3: blit_rows<3>(top_row, buffer_width, sprite.rows, shift, span_mask, color); return;
+		case 5: blit_rows<5>(top_row, buffer_width, sprite.rows, shift, span_mask, color); return;
+		case 7: blit_rows<7>(top_row, buffer_width, sprite.rows, shift, span_mask, color); return;
+		case 8: blit_rows<8>(top_row, buffer_width, sprite.rows, shift, span_mask, color); return;
+		}
+	}
+
+	for (ptrdiff_t yi = first_row; yi < last_row; ++yi)
+	{
+		// Walk the set bits of the clipped row mask, so transparent pixels
+		// cost nothing and there is no per pixel bounds test
+		uint32_t mask = (sprite.rows[yi] >> shift) & span_mask;
+		uint32_t* dst = buffer->data + (top - yi) * buffer_width + x0;
+		while (mask)
+		{
+			dst[count_trailing_zeros(mask)] = color;
+			mask &= mask - 1;
+		}
+	}
+}
+
+size_t buffer_draw_text(Buffer* buffer, const GlyphAtlas& atlas, const char* text, size_t x, size_t y, uint32_t color)
+{
+	for (const char* c = text; *c; ++c)
+	{
+		const Sprite& glyph = atlas.glyphs[static_cast<uint8_t>(*c) & (GLYPH_ATLAS_SIZE - 1)];
+		// Characters without a glyph are drawn as blanks
+		if (glyph.rows) buffer_draw_sprite(buffer, glyph, x, y, color);
+		x += GLYPH_WIDTH + 1;
+	}
+	return x;
+}
+
+size_t buffer_draw_number(Buffer* buffer, const GlyphAtlas& atlas, size_t number, size_t x, size_t y, uint32_t color)
+{
+	char digits[24];
+	snprintf(digits, sizeof(digits), "%zu", number);
+	return buffer_draw_text(buffer, atlas, digits, x, y, color);
+}
+
+void buffer_draw_phase_timers(Buffer* buffer, const GlyphAtlas& atlas, const PhaseTimers* timers, size_t x, size_t y, uint32_t color, uint32_t background)
+{
+	const size_t line_height = GLYPH_HEIGHT + 2;
+	const size_t column_width = 6 * (GLYPH_WIDTH + 1);
+	const size_t label_width = 8 * (GLYPH_WIDTH + 1);
+
+	// Only the phases this thread timed get a line
+	size_t lines = 0;
+	for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+	{
+		if (phase_timers_recorded(timers, static_cast<Phase>(phase))) ++lines;
+	}
+
+	size_t height = (lines + 1) * line_height + 2;
+	buffer_fill_rect(buffer, x, y + 1 - height, label_width + 3 * column_width + 2, height, background);
+
+	x += 2;
+	y -= GLYPH_HEIGHT + 1;
+	buffer_draw_text(buffer, atlas, "MIN", x + label_width, y, color);
+	buffer_draw_text(buffer, atlas, "AVG", x + label_width + column_width, y, color);
+	buffer_draw_text(buffer, atlas, "P99", x + label_width + 2 * column_width, y, color);
+
+	for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+	{
+		if (!phase_timers_recorded(timers, static_cast<Phase>(phase))) continue;
+		y -= line_height;
+		PhaseStats stats = phase_timers_stats(timers, static_cast<Phase>(phase));
+		buffer_draw_text(buffer, atlas, phase_label(static_cast<Phase>(phase)), x, y, color);
+		buffer_draw_number(buffer, atlas, static_cast<size_t>(stats.min_us + 0.5), x + label_width, y, color);
+		buffer_draw_number(buffer, atlas, static_cast<size_t>(stats.avg_us + 0.5), x + label_width + column_width, y, color);
+		buffer_draw_number(buffer, atlas, static_cast<size_t>(stats.p99_us + 0.5), x + label_width + 2 * column_width, y, color);
+	}
+}
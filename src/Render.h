@@ -0,0 +1,23 @@
+#pragma once
+#include "Items.h"
+#include "Sprites.h"
+#include "PhaseTimers.h"
+#include "Dirty.h"
+
+uint32_t rgb_to_uint32(uint8_t r, uint8_t g, uint8_t b);
+void buffer_clear(Buffer* buffer, uint32_t color);
+// Fills the rectangle whose bottom left corner is (x, y), clipped to the buffer
+void buffer_fill_rect(Buffer* buffer, size_t x, size_t y, size_t width, size_t height, uint32_t color);
+void buffer_draw_sprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t color);
+
+// Text drawing only reads the prebuilt glyph atlas, so it never allocates.
+// Both return the x position right after the last character drawn
+size_t buffer_draw_text(Buffer* buffer, const GlyphAtlas& atlas, const char* text, size_t x, size_t y, uint32_t color);
+size_t buffer_draw_number(Buffer* buffer, const GlyphAtlas& atlas, size_t number, size_t x, size_t y, uint32_t color);
+
+// Copies the rectangles of the buffer into dst, which has the same layout
+void buffer_copy_rects(const Buffer* buffer, uint32_t* dst, const DirtyRect* rects, size_t num_rects);
+
+// Table of the rolling min/avg/p99 time of every phase timed, in microseconds,
+// with its top left corner at (x, y) on a filled background
+void buffer_draw_phase_timers(Buffer* buffer, const GlyphAtlas& atlas, const PhaseTimers* timers, size_t x, size_t y, uint32_t color, uint32_t background);
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "Replay.h"
+
+// Everything is read in place, so the layout must not depend on the compiler
+static_assert(sizeof(ReplayHeader) == 16 && sizeof(ReplayChunk) == 1008 && sizeof(ReplayFooter) == 48,
+	"Unexpected replay layout");
+
+static uint8_t run_input(const Input& input)
+{
+	return static_cast<uint8_t>((input.move_dir + 1) | (input.fire ? 4 : 0));
+}
+
+static size_t run_length(uint8_t run)
+{
+	return (run >> 3) + 1;
+}
+
+static size_t align8(size_t size)
+{
+	return (size + 7) & ~size_t(7);
+}
+
+ReplayRecorder* CreateReplayRecorder(const char* path, uint32_t seed) {
+	FILE* file = fopen(path, "wb");
+	if (!file) return NULL;
+
+	ReplayHeader header;
+	header.magic = REPLAY_MAGIC;
+	header.version = REPLAY_VERSION;
+	header.seed = seed;
+	header.keyframe_interval = REPLAY_KEYFRAME_INTERVAL;
+	fwrite(&header, sizeof(header), 1, file);
+
+	ReplayRecorder* recorder = new ReplayRecorder;
+	recorder->file = file;
+	recorder->offset = sizeof(header);
+	recorder->num_ticks = 0;
+	recorder->capacity = 256;
+	recorder->index = new uint64_t[recorder->capacity];
+	recorder->num_keyframes = 0;
+	recorder->chunk.num_runs = 0;
+	recorder->chunk.padding = 0;
+	return recorder;
+}
+
+void DestroyReplayRecorder(ReplayRecorder* recorder) {
+	if (recorder->file) fclose(recorder->file);
+	delete[] recorder->index;
+	delete recorder;
+}
+
+// Writes the chunk being recorded, padded to 8 bytes
+static void flush_chunk(ReplayRecorder* recorder)
+{
+	static const uint8_t zeros[8] = {};
+	size_t size = sizeof(ReplayChunk) + recorder->chunk.num_runs;
+	fwrite(&recorder->chunk, sizeof(ReplayChunk), 1, recorder->file);
+	fwrite(recorder->runs, 1, recorder->chunk.num_runs, recorder->file);
+	fwrite(zeros, 1, align8(size) - size, recorder->file);
+	recorder->offset += align8(size);
+}
+
+// Writes the chunk so far and starts a new one with a keyframe of the
+// state before the next tick
+static void start_chunk(ReplayRecorder* recorder, const Simulation& sim)
+{
+	// The index starts with room for a few keyframes, it only grows once
+	// chunks have been written
+	if (recorder->num_keyframes)
+	{
+		flush_chunk(recorder);
+		if (recorder->num_keyframes == recorder->capacity)
+		{
+			uint64_t* index = new uint64_t[recorder->capacity * 2];
+			std::copy(recorder->index, recorder->index + recorder->num_keyframes, index);
+			delete[] recorder->index;
+			recorder->index = index;
+			recorder->capacity *= 2;
+		}
+	}
+	recorder->index[recorder->num_keyframes++] = recorder->offset;
+	recorder->chunk.state = sim.game;
+	recorder->chunk.num_runs = 0;
+}
+
+void replay_record(ReplayRecorder* recorder, const Simulation& sim, const Input& input)
+{
+	if (recorder->num_ticks % REPLAY_KEYFRAME_INTERVAL == 0) start_chunk(recorder, sim);
+	++recorder->num_ticks;
+
+	// Extend the last run while the input stays the same
+	uint8_t bits = run_input(input);
+	uint32_t& num_runs = recorder->chunk.num_runs;
+	if (num_runs)
+	{
+		uint8_t& last = recorder->runs[num_runs - 1];
+		if ((last & 7) == bits && run_length(last) < REPLAY_MAX_RUN)
+		{
+			last += 8;
+			return;
+		}
+	}
+	recorder->runs[num_runs++] = bits;
+}
+
+bool replay_recorder_finish(ReplayRecorder* recorder, const Simulation& sim)
+{
+	// Even a replay without any tick has the keyframe to seek to
+	if (!recorder->num_keyframes) start_chunk(recorder, sim);
+	flush_chunk(recorder);
+
+	ReplayFooter footer;
+	footer.result = replay_result(sim);
+	footer.num_ticks = recorder->num_ticks;
+	footer.num_keyframes = static_cast<uint32_t>(recorder->num_keyframes);
+	footer.index_offset = recorder->offset;
+	footer.magic = REPLAY_MAGIC;
+	footer.version = REPLAY_VERSION;
+	fwrite(recorder->index, sizeof(uint64_t), recorder->num_keyframes, recorder->file);
+	fwrite(&footer, sizeof(footer), 1, recorder->file);
+
+	bool written = !ferror(recorder->file);
+	written = fclose(recorder->file) == 0 && written;
+	recorder->file = NULL;
+	return written;
+}
+
+ReplayResult replay_result(const Simulation& sim)
+{
+	ReplayResult result;
+	result.score = sim.game.score;
+	result.alive = sim.game.aliens.alive;
+	result.life = static_cast<uint32_t>(sim.game.player.life);
+	result.ticks = sim.game.tick;
+	return result;
+}
+
+bool replay_results_equal(const ReplayResult& a, const ReplayResult& b)
+{
+	return a.score == b.score && a.alive == b.alive && a.life == b.life && a.ticks == b.ticks;
+}
+
+// Checks everything seeking relies on, so a truncated or foreign file is
+// rejected instead of read out of bounds
+static bool parse_replay(Replay* replay)
+{
+	const MappedFile& file = replay->file;
+	if (file.size < sizeof(ReplayHeader) + sizeof(ReplayFooter)) return false;
+
+	const ReplayHeader* header = reinterpret_cast<const ReplayHeader*>(file.bytes);
+	const ReplayFooter* footer = reinterpret_cast<const ReplayFooter*>(file.bytes + file.size - sizeof(ReplayFooter));
+	if (header->magic != REPLAY_MAGIC || header->version != REPLAY_VERSION) return false;
+	if (footer->magic != REPLAY_MAGIC || footer->version != REPLAY_VERSION) return false;
+	if (header->keyframe_interval != REPLAY_KEYFRAME_INTERVAL) return false;
+
+	uint64_t index_size = uint64_t(footer->num_keyframes) * sizeof(uint64_t);
+	if (footer->index_offset % 8 || footer->index_offset + index_size + sizeof(ReplayFooter) != file.size) return false;
+	uint64_t needed_keyframes = std::max((uint64_t(footer->num_ticks) + REPLAY_KEYFRAME_INTERVAL - 1) / REPLAY_KEYFRAME_INTERVAL, uint64_t(1));
+	if (footer->num_keyframes != needed_keyframes || footer->result.ticks != footer->num_ticks) return false;
+
+	// Chunks are in file order, each at least a ReplayChunk long
+	const uint64_t* index = reinterpret_cast<const uint64_t*>(file.bytes + footer->index_offset);
+	uint64_t end = sizeof(ReplayHeader);
+	for (size_t k = 0; k < footer->num_keyframes; ++k)
+	{
+		if (index[k] % 8 || index[k] < end) return false;
+		end = index[k] + sizeof(ReplayChunk);
+	}
+	if (end > footer->index_offset) return false;
+
+	replay->header = header;
+	replay->footer = footer;
+	replay->index = index;
+	return true;
+}
+
+bool LoadReplay(const char* path, Replay* replay) {
+	if (!MapFile(path, &replay->file)) return false;
+	if (!parse_replay(replay))
+	{
+		UnmapFile(&replay->file);
+		return false;
+	}
+	return true;
+}
+
+void DestroyReplay(Replay* replay) {
+	UnmapFile(&replay->file);
+}
+
+const ReplayChunk* replay_chunk(const Replay* replay, size_t keyframe)
+{
+	uint64_t offset = replay->index[keyframe];
+	uint64_t end = keyframe + 1 < replay->footer->num_keyframes ? replay->index[keyframe + 1] : replay->footer->index_offset;
+	const ReplayChunk* chunk = reinterpret_cast<const ReplayChunk*>(replay->file.bytes + offset);
+	if (offset + sizeof(ReplayChunk) + chunk->num_runs > end) return NULL;
+	if (chunk->state.tick != keyframe * REPLAY_KEYFRAME_INTERVAL) return NULL;
+	// The state is copied into a simulation as it is, it must not make
+	// step index past its arrays
+	if (!game_valid(chunk->state)) return NULL;
+	return chunk;
+}
+
+// Points the cursor at the first run of a chunk. At a chunk that is not
+// valid the cursor moves past the last one, so the ticks after it are
+// never read either
+static bool enter_chunk(ReplayCursor* cursor, size_t keyframe)
+{
+	cursor->keyframe = keyframe;
+	cursor->run = 0;
+	cursor->tick_in_run = 0;
+	cursor->num_runs = 0;
+	cursor->runs = NULL;
+	if (keyframe >= cursor->replay->footer->num_keyframes) return false;
+
+	const ReplayChunk* chunk = replay_chunk(cursor->replay, keyframe);
+	if (!chunk)
+	{
+		cursor->keyframe = cursor->replay->footer->num_keyframes;
+		return false;
+	}
+	cursor->runs = reinterpret_cast<const uint8_t*>(chunk + 1);
+	cursor->num_runs = chunk->num_runs;
+	return true;
+}
+
+ReplayCursor replay_begin(const Replay* replay)
+{
+	ReplayCursor cursor;
+	cursor.replay = replay;
+	enter_chunk(&cursor, 0);
+	return cursor;
+}
+
+bool replay_next(ReplayCursor* cursor, Input* input)
+{
+	if (cursor->run == cursor->num_runs)
+	{
+		if (!enter_chunk(cursor, cursor->keyframe + 1) || !cursor->num_runs) return false;
+	}
+
+	uint8_t run = cursor->runs[cursor->run];
+	input->move_dir = static_cast<int>(run & 3) - 1;
+	input->fire = (run & 4) != 0;
+
+	if (++cursor->tick_in_run == run_length(run))
+	{
+		++cursor->run;
+		cursor->tick_in_run = 0;
+	}
+	return true;
+}
+
+ReplayCursor replay_seek(const Replay* replay, Simulation* sim, size_t tick)
+{
+	ReplayCursor cursor;
+	cursor.replay = replay;
+	size_t keyframe = std::min(tick / REPLAY_KEYFRAME_INTERVAL, size_t(replay->footer->num_keyframes) - 1);
+	if (!enter_chunk(&cursor, keyframe)) return cursor;
+	sim->game = replay_chunk(replay, keyframe)->state;
+
+	Input input;
+	while (sim->game.tick < tick && replay_next(&cursor, &input))
+	{
+		sim->step(input);
+	}
+	return cursor;
+}
+
+ReplayResult replay_simulate(const Replay* replay, const GameSprites& sprites, size_t* first_mismatch)
+{
+	Simulation* sim = new Simulation(sprites, replay->header->seed);
+	*first_mismatch = SIZE_MAX;
+
+	ReplayCursor cursor = replay_begin(replay);
+	for (size_t keyframe = 0; keyframe < replay->footer->num_keyframes; ++keyframe)
+	{
+		const ReplayChunk* chunk = replay_chunk(replay, keyframe);
+		if (!chunk)
+		{
+			*first_mismatch = std::min(*first_mismatch, size_t(sim->game.tick));
+			break;
+		}
+		if (*first_mismatch == SIZE_MAX && memcmp(&sim->game, &chunk->state, sizeof(Game)) != 0)
+		{
+			*first_mismatch = sim->game.tick;
+		}
+
+		Input input;
+		for (size_t t = 0; t < REPLAY_KEYFRAME_INTERVAL && replay_next(&cursor, &input); ++t)
+		{
+			sim->step(input);
+		}
+	}
+
+	ReplayResult result = replay_result(*sim);
+	delete sim;
+	return result;
+}
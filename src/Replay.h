@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "MappedFile.h"
+#include "Simulation.h"
+
+// Recording of one game, enough to play it again bit for bit and to jump
+// anywhere in it. The simulation is deterministic given its seed and the
+// input of every tick. Every REPLAY_KEYFRAME_INTERVAL ticks the file also
+// holds a copy of the whole game, so seeking restores the last keyframe and then
+// simulates less than an interval. The file ends with the state the game
+// ended in, to check a re-simulation against, and an index of keyframes.
+//
+// File layout, little endian, chunks 8-byte aligned:
+//   ReplayHeader
+//   one chunk per keyframe, at least one:
+//     ReplayChunk, the game before the chunk's first tick
+//     uint8_t runs[num_runs], the inputs of up to an interval of ticks
+//   uint64_t index[num_keyframes], the offset of every chunk
+//   ReplayFooter
+// Each run byte is a tick input repeated for 1 to 32 ticks: bits 0-1 are
+// move_dir + 1, bit 2 is fire and bits 3-7 are the tick count minus one.
+// Files are mapped, so only the pages of the chunks used are ever read
+#define REPLAY_MAGIC 0x594c5052 // "RPLY"
+#define REPLAY_VERSION 4
+#define REPLAY_MAX_RUN 32
+// About 2 s of game, a keyframe every interval costs around 500 bytes/s
+#define REPLAY_KEYFRAME_INTERVAL 256
+
+// What a replay is checked on
+struct ReplayResult
+{
+	uint64_t score;
+	uint64_t alive;
+	uint32_t life;
+	uint32_t ticks;
+};
+
+struct ReplayHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t seed;
+	uint32_t keyframe_interval;
+};
+
+struct ReplayChunk
+{
+	Game state;
+	uint32_t num_runs;
+	uint32_t padding;
+};
+
+struct ReplayFooter
+{
+	ReplayResult result;
+	uint32_t num_ticks;
+	uint32_t num_keyframes;
+	uint64_t index_offset;
+	uint32_t magic;
+	uint32_t version;
+};
+
+// Writes a replay as the game is played, a chunk at a time, so a long
+// session takes no more memory than a short one
+struct ReplayRecorder
+{
+	FILE* file;
+	uint64_t offset;
+	uint32_t num_ticks;
+	uint64_t* index;
+	size_t num_keyframes, capacity;
+	ReplayChunk chunk;
+	uint8_t runs[REPLAY_KEYFRAME_INTERVAL];
+};
+
+// Returns NULL when the file can not be created
+ReplayRecorder* CreateReplayRecorder(const char* path, uint32_t seed);
+void DestroyReplayRecorder(ReplayRecorder* recorder);
+
+// Records the input of the next tick, called just before sim.step(input).
+// move_dir must be -1, 0 or 1
+void replay_record(ReplayRecorder* recorder, const Simulation& sim, const Input& input);
+// Writes the end state and the index, returns false when any write failed
+bool replay_recorder_finish(ReplayRecorder* recorder, const Simulation& sim);
+
+ReplayResult replay_result(const Simulation& sim);
+bool replay_results_equal(const ReplayResult& a, const ReplayResult& b);
+
+// A mapped replay file
+struct Replay
+{
+	MappedFile file;
+	const ReplayHeader* header;
+	const ReplayFooter* footer;
+	const uint64_t* index;
+};
+
+// Returns false, with nothing to destroy, when the file is missing or is
+// not a valid replay of this version. Only the header, footer and index
+// are checked, chunks and the states in them are checked when they are
+// used
+bool LoadReplay(const char* path, Replay* replay);
+void DestroyReplay(Replay* replay);
+
+// NULL when the chunk does not fit in the file or its state is not a
+// valid game
+const ReplayChunk* replay_chunk(const Replay* replay, size_t keyframe);
+
+// Walks the inputs of a replay tick by tick
+struct ReplayCursor
+{
+	const Replay* replay;
+	size_t keyframe;
+	const uint8_t* runs;
+	size_t num_runs;
+	size_t run;
+	size_t tick_in_run;
+};
+
+ReplayCursor replay_begin(const Replay* replay);
+// Returns false after the last tick, or at a chunk that is not valid
+bool replay_next(ReplayCursor* cursor, Input* input);
+
+// Puts sim in the state it had just before the given tick: restores the
+// keyframe at or before it, found in the index, then simulates the ticks
+// in between. Returns the cursor at that tick's input. When the keyframe
+// is not valid, sim is left as it was and the cursor is at the end
+ReplayCursor replay_seek(const Replay* replay, Simulation* sim, size_t tick);
+
+// Steps a new simulation through every input of the replay, as fast as
+// the CPU allows, and returns the state it ends in. Every keyframe is
+// compared with the re-simulated state on the way; first_mismatch gets
+// the tick of the first one that differs, or SIZE_MAX
+ReplayResult replay_simulate(const Replay* replay, const GameSprites& sprites, size_t* first_mismatch);
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cstring>
+#include "Bits.h"
+#include "Rewind.h"
+
+// The XOR is taken a word at a time
+#define GAME_WORDS (sizeof(Game) / 8)
+static_assert(sizeof(Game) % 8 == 0, "Games must be whole words");
+static_assert(REWIND_INTERVAL <= 32, "The inputs of an interval must fit in runs of up to 32 ticks");
+static_assert(REWIND_MAX_RECORD <= 0xffff, "Record sizes are 16 bits");
+
+RewindBuffer* CreateRewindBuffer(size_t capacity) {
+	RewindBuffer* rewind = new RewindBuffer;
+	rewind->capacity = std::max(capacity, size_t(REWIND_MAX_RECORD));
+	rewind->bytes = new uint8_t[rewind->capacity];
+	rewind->head = 0;
+	rewind->used = 0;
+	rewind->num_records = 0;
+	rewind->has_state = false;
+	rewind->num_inputs = 0;
+	return rewind;
+}
+
+void DestroyRewindBuffer(RewindBuffer* rewind) {
+	delete[] rewind->bytes;
+	delete rewind;
+}
+
+// Copies to and from the buffer, wrapping around its end
+static void ring_write(RewindBuffer* rewind, size_t pos, const uint8_t* src, size_t size)
+{
+	size_t first = std::min(size, rewind->capacity - pos);
+	memcpy(rewind->bytes + pos, src, first);
+	memcpy(rewind->bytes, src + first, size - first);
+}
+
+static void ring_read(const RewindBuffer* rewind, size_t pos, uint8_t* dst, size_t size)
+{
+	size_t first = std::min(size, rewind->capacity - pos);
+	memcpy(dst, rewind->bytes + pos, first);
+	memcpy(dst + first, rewind->bytes, size - first);
+}
+
+static size_t ring_read_size(const RewindBuffer* rewind, size_t pos)
+{
+	uint8_t size[2];
+	ring_read(rewind, pos, size, 2);
+	return size[0] | (size_t(size[1]) << 8);
+}
+
+static uint8_t* write_size(uint8_t* out, size_t size)
+{
+	out[0] = static_cast<uint8_t>(size);
+	out[1] = static_cast<uint8_t>(size >> 8);
+	return out + 2;
+}
+
+// Position of the first non-zero byte of the XOR at or after pos, found
+// a word at a time. Words are little endian, as the rest of the format
+static size_t next_change(const uint64_t* delta, size_t pos)
+{
+	size_t w = pos / 8;
+	uint64_t word = delta[w] & (~uint64_t(0) << (8 * (pos & 7)));
+	while (!word)
+	{
+		if (++w == GAME_WORDS) return sizeof(Game);
+		word = delta[w];
+	}
+	return w * 8 + count_trailing_zeros64(word) / 8;
+}
+
+// Turns the XOR of two states into tokens
+static uint8_t* encode_delta(const uint64_t* delta, uint8_t* out)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(delta);
+	const size_t size = sizeof(Game);
+	size_t last = 0;
+	for (size_t i = next_change(delta, 0); i < size; i = next_change(delta, last))
+	{
+		size_t literals = 1;
+		while (i + literals < size && bytes[i + literals] && literals < 16) ++literals;
+
+		size_t skip = i - last;
+		if (skip < 15) *out++ = static_cast<uint8_t>((skip << 4) | (literals - 1));
+		else
+		{
+			*out++ = static_cast<uint8_t>(0xf0 | (literals - 1));
+			for (skip -= 15; skip >= 255; skip -= 255) *out++ = 255;
+			*out++ = static_cast<uint8_t>(skip);
+		}
+		memcpy(out, bytes + i, literals);
+		out += literals;
+		last = i + literals;
+	}
+	return out;
+}
+
+// XORs the tokens into a state
+static void apply_delta(const uint8_t* in, const uint8_t* end, Game* state)
+{
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(state);
+	size_t pos = 0;
+	while (in < end)
+	{
+		uint8_t token = *in++;
+		size_t skip = token >> 4;
+		if (skip == 15)
+		{
+			uint8_t more;
+			do
+			{
+				more = *in++;
+				skip += more;
+			} while (more == 255);
+		}
+		pos += skip;
+		for (size_t n = (token & 15) + 1; n; --n) bytes[pos++] ^= *in++;
+	}
+}
+
+static void drop_oldest(RewindBuffer* rewind)
+{
+	size_t tail = (rewind->head + rewind->capacity - rewind->used) % rewind->capacity;
+	rewind->used -= ring_read_size(rewind, tail);
+	--rewind->num_records;
+}
+
+// Stores the inputs since the last capture and what changed from it to
+// state, which becomes the newest
+static void push_record(RewindBuffer* rewind, const Game& state)
+{
+	uint64_t delta[GAME_WORDS];
+	memcpy(delta, &state, sizeof(state));
+	const uint8_t* newest = reinterpret_cast<const uint8_t*>(&rewind->newest);
+	for (size_t w = 0; w < GAME_WORDS; ++w)
+	{
+		uint64_t word;
+		memcpy(&word, newest + 8 * w, 8);
+		delta[w] ^= word;
+	}
+	rewind->newest = state;
+
+	uint8_t record[REWIND_MAX_RECORD];
+	uint8_t* out = record + 3;
+	uint8_t num_runs = 0;
+	for (size_t t = 0; t < rewind->num_inputs; ++t)
+	{
+		const Input& input = rewind->inputs[t];
+		uint8_t bits = static_cast<uint8_t>((input.move_dir + 1) | (input.fire ? 4 : 0));
+		if (num_runs && (out[-1] & 7) == bits) out[-1] += 8;
+		else
+		{
+			*out++ = bits;
+			++num_runs;
+		}
+	}
+	record[2] = num_runs;
+	out = encode_delta(delta, out);
+
+	size_t size = out + 2 - record;
+	write_size(record, size);
+	write_size(out, size);
+
+	while (rewind->capacity - rewind->used < size) drop_oldest(rewind);
+	ring_write(rewind, rewind->head, record, size);
+	rewind->head = (rewind->head + size) % rewind->capacity;
+	rewind->used += size;
+	++rewind->num_records;
+}
+
+// Takes the newest record back out, making the capture before it the
+// newest, with the inputs that followed it
+static void pop_record(RewindBuffer* rewind)
+{
+	size_t size = ring_read_size(rewind, (rewind->head + rewind->capacity - 2) % rewind->capacity);
+	size_t start = (rewind->head + rewind->capacity - size) % rewind->capacity;
+	uint8_t record[REWIND_MAX_RECORD];
+	ring_read(rewind, start, record, size);
+	rewind->head = start;
+	rewind->used -= size;
+	--rewind->num_records;
+
+	const uint8_t* in = record + 3;
+	rewind->num_inputs = 0;
+	for (uint8_t r = 0; r < record[2]; ++r, ++in)
+	{
+		Input input;
+		input.move_dir = static_cast<int>(*in & 3) - 1;
+		input.fire = (*in & 4) != 0;
+		for (size_t n = (*in >> 3) + 1; n; --n) rewind->inputs[rewind->num_inputs++] = input;
+	}
+	apply_delta(in, record + size - 2, &rewind->newest);
+}
+
+void rewind_record(RewindBuffer* rewind, const Simulation& sim, const Input& input)
+{
+	if (!rewind->has_state)
+	{
+		rewind->newest = sim.game;
+		rewind->has_state = true;
+	}
+	else if (rewind->num_inputs == REWIND_INTERVAL)
+	{
+		push_record(rewind, sim.game);
+		rewind->num_inputs = 0;
+	}
+	rewind->inputs[rewind->num_inputs++] = input;
+}
+
+bool rewind_step_back(RewindBuffer* rewind, Simulation* sim)
+{
+	if (!rewind->num_inputs)
+	{
+		if (!rewind->num_records) return false;
+		pop_record(rewind);
+	}
+
+	--rewind->num_inputs;
+	sim->game = rewind->newest;
+	for (size_t t = 0; t < rewind->num_inputs; ++t) sim->step(rewind->inputs[t]);
+	return true;
+}
+
+size_t rewind_ticks(const RewindBuffer* rewind)
+{
+	return rewind->num_records * REWIND_INTERVAL + rewind->num_inputs;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Simulation.h"
+
+// History of the game for rewinding it tick by tick, in a fixed amount of
+// memory allocated up front. Every REWIND_INTERVAL ticks the state is
+// captured and stored as a record holding its XOR against the previous
+// capture, run-length coded, and the inputs of the ticks in between.
+// Between two captures only the tick, the formation offset, the animation
+// times and the moving bullets change, so a record is a few dozen bytes.
+// Rewinding XORs the newest record back out of the last capture, restores
+// it and steps the inputs again up to the wanted tick. When the buffer is
+// full the oldest records are dropped.
+//
+// Record layout, stored as bytes so records can wrap around the buffer:
+//   uint16_t size, of the whole record
+//   uint8_t num_runs, then the runs of inputs, as in replays: bits 0-1
+//     are move_dir + 1, bit 2 is fire and bits 3-7 the ticks minus one
+//   the XOR as tokens: a byte whose bits 0-3 are the number of literal
+//     bytes minus one and bits 4-7 the zero bytes to skip first, 15 meaning
+//     15 plus the next bytes up to one that is not 255, then the literals
+//   uint16_t size, again, to walk the records from either end
+#define REWIND_INTERVAL 8
+// Larger than any record, for tokens of single bytes
+#define REWIND_MAX_RECORD (2 * sizeof(Game) + 2 * REWIND_INTERVAL + 8)
+
+struct RewindBuffer
+{
+	uint8_t* bytes;
+	size_t capacity;
+	// Where the next record goes, and how many bytes of records end there
+	size_t head, used;
+	size_t num_records;
+	// State at the last capture, and the inputs of the ticks since
+	Game newest;
+	bool has_state;
+	Input inputs[REWIND_INTERVAL];
+	size_t num_inputs;
+};
+
+// Keeps the newest records that fit in capacity bytes, at least one
+RewindBuffer* CreateRewindBuffer(size_t capacity);
+void DestroyRewindBuffer(RewindBuffer* rewind);
+
+// Records the input of the next tick, called just before sim.step(input).
+// move_dir must be -1, 0 or 1
+void rewind_record(RewindBuffer* rewind, const Simulation& sim, const Input& input);
+
+// Puts sim back one tick, the tick before the one it is at after the
+// recorded inputs. Returns false, with sim unchanged, once the oldest
+// state kept is reached. Recording again afterwards continues from there
+bool rewind_step_back(RewindBuffer* rewind, Simulation* sim);
+
+// Ticks that can be rewound
+size_t rewind_ticks(const RewindBuffer* rewind);
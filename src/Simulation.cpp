@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include "Simulation.h"
+
+// Copied with memcpy, compared with memcmp and read in place from replay
+// files, so it must hold no pointers nor padding
+static_assert(std::is_trivially_copyable<Game>::value, "Game must be copyable with memcpy");
+static_assert(sizeof(AlienArray) == 400 && sizeof(BulletArray) == 536 && sizeof(Game) == 1000, "Unexpected game layout");
+
+Game CreateGame(uint16_t width, uint16_t height, uint32_t seed) {
+	// Zero everything, the unused slots included, the overlap kernels read
+	// them and copies are compared whole
+	Game game;
+	memset(&game, 0, sizeof(game));
+	game.width = width;
+	game.height = height;
+	game.aliens.count = GAME_FORMATION_ALIENS;
+	game.aliens.alive = low_bits64(game.aliens.count);
+	for (size_t i = 0; i < game.aliens.count; ++i)
+	{
+		game.aliens.death_counters[i] = ALIEN_DEATH_TICKS;
+	}
+
+	game.player.x = 112 - 5;
+	game.player.y = 32;
+	game.player.life = 3;
+	game.prev_player_x = game.player.x;
+
+	game.random = CreateRandom(seed);
+	game.alienMoveDir = ALIEN_MARCH_SPEED / SIMULATION_TICK_RATE;
+	game.total_aliens = game.aliens.count;
+	return game;
+}
+
+// Reads a bool stored in a game as the byte it is, any other value than
+// 0 or 1 would not be a bool
+static bool valid_bool(const bool& value)
+{
+	return *reinterpret_cast<const uint8_t*>(&value) <= 1;
+}
+
+bool game_valid(const Game& game) {
+	const AlienArray& aliens = game.aliens;
+	const BulletArray& bullets = game.bullets;
+	if (!game.width || !game.height) return false;
+	if (aliens.count > GAME_FORMATION_ALIENS || bullets.count > GAME_MAX_BULLETS) return false;
+	if (aliens.alive & ~low_bits64(aliens.count)) return false;
+	if (game.total_aliens != static_cast<int32_t>(popcount64(aliens.alive))) return false;
+	for (size_t ai = 0; ai < aliens.count; ++ai)
+	{
+		if (aliens.type[ai] < ALIEN_TYPE_A || aliens.type[ai] > ALIEN_TYPE_C) return false;
+		if (aliens.x[ai] < 0 || aliens.x[ai] >= game.width || aliens.y[ai] < 0 || aliens.y[ai] >= game.height) return false;
+		if (aliens.death_counters[ai] > ALIEN_DEATH_TICKS) return false;
+	}
+	for (size_t bi = 0; bi < bullets.count; ++bi)
+	{
+		if (bullets.x[bi] < 0 || bullets.x[bi] >= game.width || bullets.y[bi] < 0 || bullets.y[bi] >= game.height) return false;
+	}
+
+	// Offsets are added to 16 bit coordinates and truncated to integers,
+	// NaN or infinite ones would pass every comparison against them
+	const float offsets[] = { game.xi, game.yi, game.prev_xi, game.prev_yi, game.alienMoveDir };
+	for (float offset : offsets)
+	{
+		if (!std::isfinite(offset) || std::fabs(offset) > INT16_MAX) return false;
+	}
+	if (game.lastAlienX < INT16_MIN || game.lastAlienX > INT16_MAX) return false;
+	if (game.last_fire_tick > game.tick) return false;
+
+	const Player& player = game.player;
+	if (player.x < 0 || player.x >= game.width || player.y < 0 || player.y >= game.height) return false;
+	if (player.life < 0 || player.life > 3) return false;
+	if (game.prev_player_x < 0 || game.prev_player_x >= game.width) return false;
+	return game.animation_time < 2 * ALIEN_FRAME_TICKS && valid_bool(game.lastAlien) && valid_bool(game.gameOver);
+}
+
+Simulation::Simulation(const GameSprites& sprites, uint32_t seed) {
+	this->sprites = &sprites;
+	game = CreateGame(224, 256, seed);
+
+	const Sprite& alien_death_sprite = sprites.alien_death_sprite;
+	size_t aliensColumn = 5;
+	aliensRow = 11;
+	offset = alien_death_sprite.width / 3;
+	size_t margin = (game.width - (alien_death_sprite.width * aliensRow + offset * (aliensRow - 1))) / 2;
+
+	for (size_t yi = 0; yi < aliensColumn; ++yi)
+	{
+		for (size_t xi = 0; xi < aliensRow; ++xi)
+		{
+			size_t ai = yi * 11 + xi;
+			game.aliens.type[ai] = (5 - yi) / 2 + 1;
+			game.aliens.x[ai] = margin + xi * (offset + alien_death_sprite.width);
+			game.aliens.y[ai] = 17 * yi + 128;
+		}
+	}
+
+	alien_grid = CreateCollisionGrid(game.aliens.x, game.aliens.y, game.aliens.type, game.aliens.count, sprites.alien_sprites);
+
+	// Both animation frames of a type have the same size
+	std::fill(alien_width, alien_width + GAME_MAX_ALIENS, 0);
+	std::fill(alien_height, alien_height + GAME_MAX_ALIENS, 0);
+	for (size_t ai = 0; ai < game.aliens.count; ++ai)
+	{
+		const Sprite& sprite = sprites.alien_sprites[2 * (game.aliens.type[ai] - 1)];
+		alien_width[ai] = static_cast<int16_t>(sprite.width);
+		alien_height[ai] = static_cast<int16_t>(sprite.height);
+	}
+
+	timers = NULL;
+}
+
+Simulation::~Simulation() {
+	DestroyCollisionGrid(alien_grid);
+}
+
+SimulationView Simulation::view(float alpha) const {
+	SimulationView view;
+	view.xi = game.prev_xi + (game.xi - game.prev_xi) * alpha;
+	view.yi = game.prev_yi + (game.yi - game.prev_yi) * alpha;
+	view.player_x = game.prev_player_x + (float(game.player.x) - float(game.prev_player_x)) * alpha;
+	view.bullet_dy = (alpha - 1) * BULLET_STEP;
+	return view;
+}
+
+const Sprite& Simulation::alien_sprite(uint8_t type) const {
+	return sprites->alien_sprites[2 * (type - 1) + game.animation_time / ALIEN_FRAME_TICKS];
+}
+
+OverlapBatch Simulation::alien_batch(float offset_x, float offset_y) {
+	overlap_translate(alien_screen_x, game.aliens.x, game.aliens.count, offset_x);
+	overlap_translate(alien_screen_y, game.aliens.y, game.aliens.count, offset_y);
+
+	OverlapBatch batch;
+	batch.x = alien_screen_x;
+	batch.y = alien_screen_y;
+	batch.width = alien_width;
+	batch.height = alien_height;
+	batch.count = game.aliens.count;
+	return batch;
+}
+
+void Simulation::step(const Input& input) {
+	const Sprite& player_sprite = sprites->player_sprite;
+	const Sprite& bullet_sprite = sprites->bullet_sprite;
+	const Sprite& alien_death_sprite = sprites->alien_death_sprite;
+
+	// The alien bookkeeping has to come before the bullets, which can kill
+	// aliens, but is timed with the march all the same
+	ScopedPhase phase(timers, PHASE_ALIEN_MARCH);
+
+	game.prev_xi = game.xi;
+	game.prev_yi = game.yi;
+	game.prev_player_x = game.player.x;
+
+	// Update the animation, two frames for every type
+	if (++game.animation_time == 2 * ALIEN_FRAME_TICKS) game.animation_time = 0;
+
+	AlienArray& aliens = game.aliens;
+	BulletArray& bullets = game.bullets;
+
+	// Simulate aliens, counting down the death animation of dead ones
+	uint64_t dead = ~aliens.alive & low_bits64(aliens.count);
+	for (; dead; dead &= dead - 1)
+	{
+		size_t ai = count_trailing_zeros64(dead);
+		if (aliens.death_counters[ai]) --aliens.death_counters[ai];
+	}
+
+	phase.next(PHASE_BULLET_SIM);
+
+	// Simulate bullets. Aliens are drawn and hit at half the horizontal
+	// formation offset
+	OverlapBatch alien_rects = alien_batch(game.xi / 2, game.yi);
+	ptrdiff_t shift_x = static_cast<ptrdiff_t>(floorf(game.xi / 2));
+	ptrdiff_t shift_y = static_cast<ptrdiff_t>(floorf(game.yi));
+
+	for (size_t bi = 0; bi < bullets.count;)
+	{
+		bool from_alien = bullet_from_alien(bullets, bi);
+		bullets.y[bi] += from_alien ? -BULLET_STEP : BULLET_STEP;
+		if (bullets.y[bi] >= ptrdiff_t(game.height) || bullets.y[bi] < ptrdiff_t(bullet_sprite.height))
+		{
+			bullet_remove(bullets, bi);
+			continue;
+		}
+
+		// Check hit
+		size_t bullet_x = bullets.x[bi], bullet_y = bullets.y[bi];
+		bool hit = false;
+		if (!from_alien)
+		{
+			// The grid gives the few aliens sharing a cell with the bullet,
+			// none for most bullets, and only those get the rectangle test.
+			// The grid is in formation space, and aliens are drawn at the
+			// offset rounded down, so widen the query by a pixel on each side
+			uint64_t near_aliens = 0;
+			collision_grid_visit(alien_grid,
+				ptrdiff_t(bullet_x) - shift_x - 1, ptrdiff_t(bullet_y) - shift_y - 1,
+				ptrdiff_t(bullet_x + bullet_sprite.width) - shift_x + 1, ptrdiff_t(bullet_y + bullet_sprite.height) - shift_y + 1,
+				[&](size_t ai) { near_aliens |= uint64_t(1) << ai; });
+
+			uint64_t candidates = overlap_mask_subset(alien_rects, near_aliens & aliens.alive,
+				bullet_x, bullet_y, bullet_sprite.width, bullet_sprite.height);
+
+			// Only aliens whose rectangle the bullet touches get the pixel
+			// test. The lowest index wins when it hits several, like a
+			// linear sweep would
+			size_t hit_alien = aliens.count;
+			for (; candidates; candidates &= candidates - 1)
+			{
+				size_t ai = count_trailing_zeros64(candidates);
+				if (sprite_pixels_overlap(
+					bullet_sprite, bullet_x, bullet_y,
+					alien_sprite(aliens.type[ai]), alien_rects.x[ai], alien_rects.y[ai]))
+				{
+					hit_alien = ai;
+					break;
+				}
+			}
+
+			if (hit_alien < aliens.count)
+			{
+				game.score += ((4 - static_cast<int>(aliens.type[hit_alien])) * 10);
+				aliens.alive &= ~(uint64_t(1) << hit_alien);
+				// NOTE: Hack to recenter death sprite
+				aliens.x[hit_alien] -= (alien_death_sprite.width - alien_sprite(aliens.type[hit_alien]).width) / 2;
+				--game.total_aliens;
+				hit = true;
+			}
+		}
+		else
+		{
+			const Player& player = game.player;
+
+			hit = sprite_overlap_check(
+				bullet_sprite, bullet_x, bullet_y,
+				player_sprite, player.x, player.y);
+
+			if (hit) game.player.life--;
+		}
+
+		if (hit)
+		{
+			bullet_remove(bullets, bi);
+			continue;
+		}
+
+		++bi;
+	}
+
+	// Simulate player
+	phase.next(PHASE_PLAYER_SIM);
+	int player_move_dir = game.gameOver ? 0 : PLAYER_STEP * input.move_dir;
+
+	if (player_move_dir != 0)
+	{
+		if (game.player.x + player_sprite.width + player_move_dir >= game.width)
+		{
+			game.player.x = game.width - player_sprite.width;
+		}
+		else if ((int)game.player.x + player_move_dir <= 0)
+		{
+			game.player.x = 0;
+		}
+		else game.player.x += player_move_dir;
+	}
+
+	// Process events
+	if (input.fire && !game.gameOver && bullets.count < GAME_MAX_BULLETS)
+	{
+		bullet_add(bullets,
+			game.player.x + player_sprite.width / 2,
+			game.player.y + player_sprite.height,
+			false);
+	}
+
+	// An alien picked at random among the alive ones fires every few seconds
+	if (game.tick - game.last_fire_tick > ALIEN_FIRE_TICKS && !game.gameOver &&
+		game.total_aliens > 0 && bullets.count < GAME_MAX_BULLETS)
+	{
+		uint64_t alive = aliens.alive;
+		for (uint32_t n = random_below(game.random, popcount64(alive)); n; --n) alive &= alive - 1;
+		size_t i = count_trailing_zeros64(alive);
+
+		const Sprite& sprite = sprites->alien_sprites[2 * (aliens.type[i] - 1)];
+		bullet_add(bullets,
+			aliens.x[i] + sprite.width / 2,
+			aliens.y[i] + sprite.height,
+			true);
+
+		game.last_fire_tick = game.tick;
+		if (trace_ring) trace_instant(trace_ring, "alien_fire");
+	}
+
+	if (game.score >= 990 || game.player.life == 0) {
+		game.gameOver = true;
+	}
+
+	// Update alien positions
+	phase.next(PHASE_ALIEN_MARCH);
+	if (((game.xi >= static_cast<float>(offset) * aliensRow) || ((game.xi <= -static_cast<float>(offset) * aliensRow) && (game.total_aliens > 1))) && !game.lastAlien)
+	{
+		game.yi -= 5;
+		game.alienMoveDir *= -1;
+	}
+	else if (game.total_aliens == 1 && !game.lastAlien)
+	{
+		// Find last alien's position and update bool game.lastAlien
+		for_each_alive_alien(aliens, [&](size_t i)
+		{
+			game.lastAlienX = aliens.x[i] + game.xi;
+		});
+		game.lastAlien = true;
+		game.alienMoveDir = LAST_ALIEN_SPEED / SIMULATION_TICK_RATE;
+	}
+
+	if (game.lastAlien) {
+		if ((game.lastAlienX + game.xi >= game.width) || (game.lastAlienX + game.xi <= 0)) {
+			game.alienMoveDir *= -1;
+			game.yi -= 5;
+		}
+	}
+	game.xi += game.alienMoveDir;
+
+	// Check for alien x player
+	phase.next(PHASE_COLLISION);
+	const Player& player = game.player;
+	OverlapBatch alien_player_rects = alien_batch(game.xi, game.yi);
+	uint64_t candidates = overlap_mask(alien_player_rects,
+		player.x, player.y, player_sprite.width, player_sprite.height) & aliens.alive;
+
+	for (; candidates; candidates &= candidates - 1)
+	{
+		size_t ai = count_trailing_zeros64(candidates);
+		if (sprite_pixels_overlap(
+			alien_sprite(aliens.type[ai]), alien_player_rects.x[ai], alien_player_rects.y[ai],
+			player_sprite, player.x, player.y))
+		{
+			game.player.life = 0;
+			break;
+		}
+	}
+
+	++game.tick;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Items.h"
+#include "Sprites.h"
+#include "CollisionGrid.h"
+#include "Overlap.h"
+#include "PhaseTimers.h"
+
+// Fixed timestep of the simulation, in ticks per second. The game runs
+// at the same speed whatever the display refresh rate, the main loop
+// steps it as many times as real time requires
+#define SIMULATION_TICK_RATE 120
+#define SIMULATION_DT (1.0 / SIMULATION_TICK_RATE)
+
+// Speeds in pixels per second. Player and bullet positions are integers,
+// so their speeds must be whole pixels per tick
+#define PLAYER_SPEED 120
+#define BULLET_SPEED 120
+#define ALIEN_MARCH_SPEED 15.0f
+#define LAST_ALIEN_SPEED 300.0f
+#define PLAYER_STEP (PLAYER_SPEED / SIMULATION_TICK_RATE)
+#define BULLET_STEP (BULLET_SPEED / SIMULATION_TICK_RATE)
+
+// Ticks each alien animation frame and the death sprite are shown
+#define ALIEN_FRAME_TICKS (SIMULATION_TICK_RATE / 6)
+#define ALIEN_DEATH_TICKS (SIMULATION_TICK_RATE / 6)
+
+// Ticks between two alien shots, 3 s
+#define ALIEN_FIRE_TICKS (3 * SIMULATION_TICK_RATE)
+
+// Player input sampled once per tick
+struct Input
+{
+	int move_dir;
+	bool fire;
+};
+
+// Positions for drawing a frame between two ticks, see Simulation::view
+struct SimulationView
+{
+	float xi, yi;
+	float player_x;
+	// Added to the y of player bullets, and subtracted for alien bullets
+	float bullet_dy;
+};
+
+// All the game logic, independent of any window or GL context, so it can
+// be stepped as fast as the CPU allows
+struct Simulation
+{
+	// The whole state of the game, the rest follows from the sprites
+	Game game;
+	const GameSprites* sprites;
+	CollisionGrid alien_grid;
+	// The formation as overlap_mask rectangles: sizes from the alien
+	// types, and positions with the formation offset added
+	int16_t alien_width[GAME_MAX_ALIENS];
+	int16_t alien_height[GAME_MAX_ALIENS];
+	int16_t alien_screen_x[GAME_MAX_ALIENS];
+	int16_t alien_screen_y[GAME_MAX_ALIENS];
+	size_t offset, aliensRow;
+
+	// Optional, times the phases of step when set
+	PhaseTimers* timers;
+
+	Simulation(const GameSprites& sprites, uint32_t seed);
+	~Simulation();
+
+	Simulation(const Simulation&) = delete;
+	Simulation& operator=(const Simulation&) = delete;
+
+	// Advances the game by one tick of SIMULATION_DT seconds
+	void step(const Input& input);
+
+	// Where things are alpha of the way from the previous tick (0) to the
+	// current one (1). Bullets move at a constant speed, so only their
+	// current position is stored
+	SimulationView view(float alpha) const;
+
+	// Sprite currently used by alive aliens of a type, depends on the animation frame
+	const Sprite& alien_sprite(uint8_t type) const;
+
+	// Moves the formation rectangles by the offset and returns them
+	OverlapBatch alien_batch(float offset_x, float offset_y);
+
+};
+
+Game CreateGame(uint16_t width, uint16_t height, uint32_t seed);
+
+// Whether a game read from outside, a file say, can be stepped: counts
+// within the formation and the arrays, alive aliens of a known type,
+// everything on the board and finite offsets. A game step produced always is
+bool game_valid(const Game& game);
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include "SimulationLoop.h"
+
+SimulationLoop CreateSimulationLoop(Simulation* sim, TripleBuffer* frames, Controls* controls, double now) {
+	SimulationLoop loop;
+	loop.sim = sim;
+	loop.frames = frames;
+	loop.controls = controls;
+	loop.replay = NULL;
+	loop.rewind = NULL;
+	loop.clock = CreateTickClock(now);
+	loop.brightness = 1.0f;
+	return loop;
+}
+
+bool simulation_loop_pass(SimulationLoop* loop, double now)
+{
+	Simulation& sim = *loop->sim;
+	Controls& controls = *loop->controls;
+	for (size_t ticks = tick_clock_take(&loop->clock, now); ticks; --ticks)
+	{
+		// Back one tick for every tick of real time, until the oldest
+		// one kept
+		if (loop->rewind && controls.rewind_held)
+		{
+			if (rewind_step_back(loop->rewind, &sim) && !sim.game.gameOver) loop->brightness = 1.0f;
+			controls.fire_pressed = false;
+			continue;
+		}
+
+		// A key released while another window had focus can leave
+		// move_dir past -1 or 1, the player still moves one step
+		Input input;
+		input.move_dir = std::min(std::max(controls.move_dir.load(), -1), 1);
+		input.fire = controls.fire_pressed.exchange(false);
+		if (loop->replay) replay_record(loop->replay, sim, input);
+		if (loop->rewind) rewind_record(loop->rewind, sim, input);
+		sim.step(input);
+
+		if (sim.game.gameOver) {
+			// Gradually darken the screen, down to 0.3
+			loop->brightness -= 0.6f * static_cast<float>(SIMULATION_DT);
+			if (loop->brightness < 0.3f) loop->brightness = 0.3f;
+		}
+	}
+
+	return !triple_buffer_pending(loop->frames);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include "Replay.h"
+#include "Rewind.h"
+#include "TickClock.h"
+#include "TripleBuffer.h"
+
+// Written by the key callback on the GL thread, read by the simulation thread
+struct Controls
+{
+	std::atomic<int> move_dir;
+	std::atomic<bool> fire_pressed;
+	std::atomic<bool> rewind_held;
+};
+
+// What the simulation thread does between drawing frames, apart from the
+// drawing itself and the real clock, so it can be run on simulated time
+struct SimulationLoop
+{
+	Simulation* sim;
+	TripleBuffer* frames;
+	Controls* controls;
+	// Optional, every tick's input is recorded there
+	ReplayRecorder* replay;
+	// Optional, history to step back through while the rewind key is held
+	RewindBuffer* rewind;
+	TickClock clock;
+	// Of the frames, dimmed once the game is over
+	float brightness;
+};
+
+SimulationLoop CreateSimulationLoop(Simulation* sim, TripleBuffer* frames, Controls* controls, double now);
+
+// One pass of the loop at time now, in seconds: steps every tick due, or
+// steps back one per tick while rewinding, whether or not the GL thread
+// took the last frame. Returns true when a frame should be drawn now, and
+// false while the last one is still pending, another would only replace
+// it; the caller then waits tick_clock_wait(loop->clock) seconds
+bool simulation_loop_pass(SimulationLoop* loop, double now);
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstring>
+#include "SpriteAtlas.h"
+
+SpriteAtlas CreateSpriteAtlas(const GameSprites& sprites, const GlyphAtlas& glyphs) {
+	const Sprite* all[16 + GLYPH_ATLAS_SIZE];
+	size_t count = 0;
+	for (size_t i = 0; i < 6; ++i) all[count++] = &sprites.alien_sprites[i];
+	all[count++] = &sprites.alien_death_sprite;
+	all[count++] = &sprites.player_sprite;
+	all[count++] = &sprites.bullet_sprite;
+	all[count++] = &glyphs.life_sprite;
+	for (size_t i = 0; i < GLYPH_ATLAS_SIZE; ++i)
+	{
+		if (glyphs.glyphs[i].rows) all[count++] = &glyphs.glyphs[i];
+	}
+
+	SpriteAtlas atlas;
+	atlas.width = SPRITE_ATLAS_WIDTH;
+	atlas.num_entries = count;
+	atlas.entries = new SpriteAtlasEntry[count];
+
+	// Shelves of the tallest sprites first, the first one starting after
+	// the fill texel
+	std::sort(all, all + count, [](const Sprite* a, const Sprite* b) { return a->height > b->height; });
+	size_t x = 1, y = 0, shelf_height = 1;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (x + all[i]->width > atlas.width)
+		{
+			x = 0;
+			y += shelf_height;
+			shelf_height = 0;
+		}
+		atlas.entries[i].sprite = all[i];
+		atlas.entries[i].x = static_cast<uint16_t>(x);
+		atlas.entries[i].y = static_cast<uint16_t>(y);
+		x += all[i]->width;
+		shelf_height = std::max(shelf_height, all[i]->height);
+	}
+	atlas.height = y + shelf_height;
+
+	atlas.pixels = new uint8_t[atlas.width * atlas.height];
+	memset(atlas.pixels, 0, atlas.width * atlas.height);
+	atlas.pixels[0] = 255;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const SpriteAtlasEntry& entry = atlas.entries[i];
+		const Sprite& sprite = *entry.sprite;
+		for (size_t yi = 0; yi < sprite.height; ++yi)
+		{
+			for (size_t xi = 0; xi < sprite.width; ++xi)
+			{
+				if ((sprite.rows[yi] >> xi) & 1) atlas.pixels[(entry.y + yi) * atlas.width + entry.x + xi] = 255;
+			}
+		}
+	}
+
+	std::sort(atlas.entries, atlas.entries + count,
+		[](const SpriteAtlasEntry& a, const SpriteAtlasEntry& b) { return std::less<const Sprite*>()(a.sprite, b.sprite); });
+	return atlas;
+}
+
+void DestroySpriteAtlas(SpriteAtlas& atlas) {
+	delete[] atlas.pixels;
+	delete[] atlas.entries;
+	atlas.pixels = NULL;
+	atlas.entries = NULL;
+}
+
+const SpriteAtlasEntry* sprite_atlas_find(const SpriteAtlas& atlas, const Sprite* sprite)
+{
+	const SpriteAtlasEntry* begin = atlas.entries;
+	const SpriteAtlasEntry* end = begin + atlas.num_entries;
+	const SpriteAtlasEntry* entry = std::lower_bound(begin, end, sprite,
+		[](const SpriteAtlasEntry& e, const Sprite* s) { return std::less<const Sprite*>()(e.sprite, s); });
+	return entry != end && entry->sprite == sprite ? entry : NULL;
+}
+
+static int16_t clamp_int16(ptrdiff_t value)
+{
+	return static_cast<int16_t>(std::min<ptrdiff_t>(std::max<ptrdiff_t>(value, INT16_MIN), INT16_MAX));
+}
+
+size_t sprite_atlas_instances(const SpriteAtlas& atlas, const DrawList* list, SpriteInstance* instances)
+{
+	size_t count = 0;
+	for (size_t i = 0; i < list->count; ++i)
+	{
+		const DrawCommand& command = list->commands[i];
+		SpriteInstance& instance = instances[count];
+		if (command.sprite)
+		{
+			const SpriteAtlasEntry* entry = sprite_atlas_find(atlas, command.sprite);
+			if (!entry) continue;
+			instance.atlas_x = entry->x;
+			instance.atlas_y = entry->y;
+		}
+		else
+		{
+			instance.atlas_x = 0;
+			instance.atlas_y = 0;
+		}
+		instance.atlas_width = command.sprite ? static_cast<uint16_t>(command.width) : 1;
+		instance.atlas_height = command.sprite ? static_cast<uint16_t>(command.height) : 1;
+		instance.x = clamp_int16(command.x);
+		instance.y = clamp_int16(command.y);
+		instance.width = clamp_int16(command.width);
+		instance.height = clamp_int16(command.height);
+		instance.color = command.color;
+		++count;
+	}
+	return count;
+}
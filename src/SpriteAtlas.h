@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Items.h"
+#include "Sprites.h"
+#include "TileRaster.h"
+
+#define SPRITE_ATLAS_WIDTH 128
+
+// Where a sprite's pixels are in the atlas, row 0 being its top row
+struct SpriteAtlasEntry
+{
+	const Sprite* sprite;
+	uint16_t x, y;
+};
+
+// Every sprite the game draws, packed into one single channel image for
+// the GPU, 255 where a sprite is opaque. Texel (0, 0) is opaque and
+// belongs to no sprite, fills stretch it over their rectangle
+struct SpriteAtlas
+{
+	size_t width, height;
+	uint8_t* pixels;
+	// Sorted by sprite address for sprite_atlas_find
+	SpriteAtlasEntry* entries;
+	size_t num_entries;
+};
+
+SpriteAtlas CreateSpriteAtlas(const GameSprites& sprites, const GlyphAtlas& glyphs);
+void DestroySpriteAtlas(SpriteAtlas& atlas);
+
+// NULL for a sprite that is not in the atlas
+const SpriteAtlasEntry* sprite_atlas_find(const SpriteAtlas& atlas, const Sprite* sprite);
+
+// One quad of the GPU renderer: a screen rectangle, bottom left origin
+// like Buffer, textured by an atlas rectangle and drawn in one color
+// where the atlas is opaque
+struct SpriteInstance
+{
+	int16_t x, y, width, height;
+	uint16_t atlas_x, atlas_y, atlas_width, atlas_height;
+	uint32_t color;
+};
+
+// Turns the draws into instances, in the same order so later draws still
+// cover earlier ones. Sprites missing from the atlas are skipped. Returns
+// the number of instances written, at most list->count
+size_t sprite_atlas_instances(const SpriteAtlas& atlas, const DrawList* list, SpriteInstance* instances);
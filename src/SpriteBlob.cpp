@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <vector>
+#include "SpriteBlob.h"
+
+// The file is read in place, so the layout must not depend on the compiler
+static_assert(sizeof(SpriteBlobHeader) == 16 && sizeof(SpriteBlobEntry) == 8, "Unexpected sprite blob layout");
+
+static void add_sprite(const Sprite& sprite, uint16_t id, std::vector<SpriteBlobEntry>& entries, std::vector<uint32_t>& rows)
+{
+	if (!sprite.rows) return;
+	SpriteBlobEntry entry;
+	entry.id = id;
+	entry.width = static_cast<uint8_t>(sprite.width);
+	entry.height = static_cast<uint8_t>(sprite.height);
+	entry.first_row = static_cast<uint32_t>(rows.size());
+	entries.push_back(entry);
+	rows.insert(rows.end(), sprite.rows, sprite.rows + sprite.height);
+}
+
+bool write_sprite_blob(const char* path, const GameSprites& sprites, const GlyphAtlas& glyphs)
+{
+	std::vector<SpriteBlobEntry> entries;
+	std::vector<uint32_t> rows;
+	for (uint16_t i = 0; i < 6; ++i) add_sprite(sprites.alien_sprites[i], SPRITE_ID_ALIEN + i, entries, rows);
+	add_sprite(sprites.alien_death_sprite, SPRITE_ID_ALIEN_DEATH, entries, rows);
+	add_sprite(sprites.player_sprite, SPRITE_ID_PLAYER, entries, rows);
+	add_sprite(sprites.bullet_sprite, SPRITE_ID_BULLET, entries, rows);
+	add_sprite(glyphs.life_sprite, SPRITE_ID_LIFE, entries, rows);
+	for (uint16_t i = 0; i < GLYPH_ATLAS_SIZE; ++i) add_sprite(glyphs.glyphs[i], SPRITE_ID_GLYPH + i, entries, rows);
+
+	SpriteBlobHeader header;
+	header.magic = SPRITE_BLOB_MAGIC;
+	header.version = SPRITE_BLOB_VERSION;
+	header.num_sprites = static_cast<uint32_t>(entries.size());
+	header.num_rows = static_cast<uint32_t>(rows.size());
+
+	FILE* file = fopen(path, "wb");
+	if (!file) return false;
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(entries.data(), sizeof(SpriteBlobEntry), entries.size(), file);
+	fwrite(rows.data(), sizeof(uint32_t), rows.size(), file);
+	return fclose(file) == 0;
+}
+
+// Checks everything a sprite lookup relies on, so a truncated or foreign
+// file is rejected instead of read out of bounds
+static bool parse_sprite_blob(SpriteBlob* blob)
+{
+	if (blob->size < sizeof(SpriteBlobHeader)) return false;
+	const SpriteBlobHeader* header = reinterpret_cast<const SpriteBlobHeader*>(blob->bytes);
+	if (header->magic != SPRITE_BLOB_MAGIC || header->version != SPRITE_BLOB_VERSION) return false;
+	if (header->num_sprites > SPRITE_ID_COUNT) return false;
+
+	size_t entries_size = header->num_sprites * sizeof(SpriteBlobEntry);
+	size_t rows_size = size_t(header->num_rows) * sizeof(uint32_t);
+	if (blob->size != sizeof(SpriteBlobHeader) + entries_size + rows_size) return false;
+
+	const SpriteBlobEntry* entries = reinterpret_cast<const SpriteBlobEntry*>(blob->bytes + sizeof(SpriteBlobHeader));
+	const uint32_t* rows = reinterpret_cast<const uint32_t*>(blob->bytes + sizeof(SpriteBlobHeader) + entries_size);
+
+	for (size_t id = 0; id < SPRITE_ID_COUNT; ++id)
+	{
+		blob->sprites[id].width = id >= SPRITE_ID_GLYPH ? GLYPH_WIDTH : 0;
+		blob->sprites[id].height = id >= SPRITE_ID_GLYPH ? GLYPH_HEIGHT : 0;
+		blob->sprites[id].rows = NULL;
+	}
+	for (size_t i = 0; i < header->num_sprites; ++i)
+	{
+		const SpriteBlobEntry& entry = entries[i];
+		if (entry.id >= SPRITE_ID_COUNT || entry.width > SPRITE_MAX_WIDTH) return false;
+		if (size_t(entry.first_row) + entry.height > header->num_rows) return false;
+		Sprite& sprite = blob->sprites[entry.id];
+		sprite.width = entry.width;
+		sprite.height = entry.height;
+		sprite.rows = rows + entry.first_row;
+	}
+
+	// The game can not run without any of its own sprites
+	for (size_t id = 0; id <= SPRITE_ID_LIFE; ++id)
+	{
+		if (!blob->sprites[id].rows) return false;
+	}
+	return true;
+}
+
+bool LoadSpriteBlob(const char* path, SpriteBlob* blob) {
+	FILE* file = fopen(path, "rb");
+	if (!file) return false;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	// One read into one allocation, the sprites then point into it
+	uint8_t* bytes = size > 0 ? new uint8_t[size] : NULL;
+	bool read = bytes && fread(bytes, 1, size, file) == size_t(size);
+	fclose(file);
+
+	blob->bytes = bytes;
+	blob->size = size > 0 ? size_t(size) : 0;
+	if (!read || !parse_sprite_blob(blob))
+	{
+		delete[] bytes;
+		return false;
+	}
+	return true;
+}
+
+void DestroySpriteBlob(SpriteBlob* blob) {
+	delete[] blob->bytes;
+	blob->bytes = NULL;
+}
+
+GameSprites sprite_blob_game_sprites(SpriteBlob* blob)
+{
+	GameSprites sprites;
+	sprites.alien_sprites = &blob->sprites[SPRITE_ID_ALIEN];
+	sprites.alien_death_sprite = blob->sprites[SPRITE_ID_ALIEN_DEATH];
+	sprites.player_sprite = blob->sprites[SPRITE_ID_PLAYER];
+	sprites.bullet_sprite = blob->sprites[SPRITE_ID_BULLET];
+	return sprites;
+}
+
+GlyphAtlas sprite_blob_glyphs(const SpriteBlob* blob)
+{
+	GlyphAtlas glyphs;
+	for (size_t i = 0; i < GLYPH_ATLAS_SIZE; ++i)
+	{
+		glyphs.glyphs[i] = blob->sprites[SPRITE_ID_GLYPH + i];
+	}
+	glyphs.life_sprite = blob->sprites[SPRITE_ID_LIFE];
+	return glyphs;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Sprites.h"
+
+// Binary file holding every sprite of the game, written offline by
+// atlaspacker. It is used in place, so loading it is a single read into
+// a single allocation, and it could be mapped as is. All fields are
+// little endian and 4-byte aligned:
+//   SpriteBlobHeader
+//   SpriteBlobEntry entries[num_sprites], sorted by id
+//   uint32_t rows[num_rows], the packed rows of every sprite back to back
+#define SPRITE_BLOB_MAGIC 0x54415053 // "SPAT"
+#define SPRITE_BLOB_VERSION 1
+
+// Sprite ids: the 6 alien frames, then the single sprites, then one per
+// glyph character
+#define SPRITE_ID_ALIEN 0
+#define SPRITE_ID_ALIEN_DEATH 6
+#define SPRITE_ID_PLAYER 7
+#define SPRITE_ID_BULLET 8
+#define SPRITE_ID_LIFE 9
+#define SPRITE_ID_GLYPH 16
+#define SPRITE_ID_COUNT (SPRITE_ID_GLYPH + GLYPH_ATLAS_SIZE)
+
+struct SpriteBlobHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_sprites;
+	uint32_t num_rows;
+};
+
+struct SpriteBlobEntry
+{
+	uint16_t id;
+	uint8_t width, height;
+	uint32_t first_row;
+};
+
+// A loaded blob. The sprites are indexed by id, the ones missing from the
+// file have NULL rows; the others point into bytes
+struct SpriteBlob
+{
+	const uint8_t* bytes;
+	size_t size;
+	Sprite sprites[SPRITE_ID_COUNT];
+};
+
+// Writes the sprites the way atlaspacker does, returns false when the
+// file can not be written
+bool write_sprite_blob(const char* path, const GameSprites& sprites, const GlyphAtlas& glyphs);
+
+// Returns false, with nothing to destroy, when the file is missing or is
+// not a valid blob of this version
+bool LoadSpriteBlob(const char* path, SpriteBlob* blob);
+void DestroySpriteBlob(SpriteBlob* blob);
+
+// The game's sprites, pointing into the blob. They stay valid while it
+// is loaded and are freed with it
+GameSprites sprite_blob_game_sprites(SpriteBlob* blob);
+GlyphAtlas sprite_blob_glyphs(const SpriteBlob* blob);
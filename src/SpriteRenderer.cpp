@@ -0,0 +1,79 @@
+#include <cstddef>
+#include "SpriteRenderer.h"
+#include "Trace.h"
+
+SpriteRenderer* CreateSpriteRenderer(const SpriteAtlas& atlas, GLuint program, size_t width, size_t height) {
+	SpriteRenderer* renderer = new SpriteRenderer;
+	renderer->program = program;
+	renderer->num_instances = 0;
+
+	// Atlas rows are tightly packed bytes
+	glGenTextures(1, &renderer->atlas_texture);
+	glBindTexture(GL_TEXTURE_2D, renderer->atlas_texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlas.width, atlas.height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	glGenVertexArrays(1, &renderer->vao);
+	glGenBuffers(1, &renderer->instance_buffer);
+	glBindVertexArray(renderer->vao);
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->instance_buffer);
+	glBufferData(GL_ARRAY_BUFFER, DRAW_LIST_MAX * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+
+	// The quad corners come from gl_VertexID, the buffer only holds one
+	// entry per instance
+	const GLsizei stride = sizeof(SpriteInstance);
+	glEnableVertexAttribArray(0);
+	glVertexAttribIPointer(0, 4, GL_SHORT, stride, reinterpret_cast<const void*>(offsetof(SpriteInstance, x)));
+	glVertexAttribDivisor(0, 1);
+	glEnableVertexAttribArray(1);
+	glVertexAttribIPointer(1, 4, GL_UNSIGNED_SHORT, stride, reinterpret_cast<const void*>(offsetof(SpriteInstance, atlas_x)));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, stride, reinterpret_cast<const void*>(offsetof(SpriteInstance, color)));
+	glVertexAttribDivisor(2, 1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+	glUniform2f(glGetUniformLocation(program, "screen_size"), static_cast<float>(width), static_cast<float>(height));
+	renderer->brightness_location = glGetUniformLocation(program, "brightness");
+
+	return renderer;
+}
+
+void DestroySpriteRenderer(SpriteRenderer* renderer) {
+	glDeleteBuffers(1, &renderer->instance_buffer);
+	glDeleteVertexArrays(1, &renderer->vao);
+	glDeleteTextures(1, &renderer->atlas_texture);
+	glDeleteProgram(renderer->program);
+	delete renderer;
+}
+
+void sprite_renderer_upload(SpriteRenderer* renderer, const SpriteInstance* instances, size_t count)
+{
+	ScopedTrace trace("glBufferSubData");
+	// Orphaning lets the driver hand out fresh storage instead of waiting
+	// for the draw still reading the previous instances
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->instance_buffer);
+	glBufferData(GL_ARRAY_BUFFER, DRAW_LIST_MAX * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(SpriteInstance), instances);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	renderer->num_instances = count;
+}
+
+void sprite_renderer_draw(SpriteRenderer* renderer, float brightness)
+{
+	ScopedTrace trace("glDrawArraysInstanced");
+	glUseProgram(renderer->program);
+	glUniform1f(renderer->brightness_location, brightness);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, renderer->atlas_texture);
+	glBindVertexArray(renderer->vao);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(renderer->num_instances));
+}
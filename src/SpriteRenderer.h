@@ -0,0 +1,25 @@
+#pragma once
+#include <GL/glew.h>
+#include "SpriteAtlas.h"
+
+// GPU backend: the sprite atlas lives in a texture and every frame is one
+// instanced draw of SpriteInstance quads, so the CPU cost of a frame only
+// depends on the number of draws, not on their size or the resolution
+struct SpriteRenderer
+{
+	GLuint program;
+	GLuint atlas_texture;
+	GLuint vao;
+	GLuint instance_buffer;
+	GLint brightness_location;
+	size_t num_instances;
+};
+
+// program is the linked shaders/Sprite.shader. width and height are the
+// game screen size the instances are given in
+SpriteRenderer* CreateSpriteRenderer(const SpriteAtlas& atlas, GLuint program, size_t width, size_t height);
+void DestroySpriteRenderer(SpriteRenderer* renderer);
+
+// Replaces the instances drawn by sprite_renderer_draw
+void sprite_renderer_upload(SpriteRenderer* renderer, const SpriteInstance* instances, size_t count);
+void sprite_renderer_draw(SpriteRenderer* renderer, float brightness);
@@ -0,0 +1,353 @@
+#include <algorithm>
+#include "Sprites.h"
+
+bool sprite_overlap_check(const Sprite& sp_a, size_t x_a, size_t y_a, const Sprite& sp_b, size_t x_b, size_t y_b)
+{
+	// Only sprites whose rectangles overlap can share a pixel, and the
+	// rectangle test is much cheaper
+	if (x_a < x_b + sp_b.width && x_a + sp_a.width > x_b &&
+		y_a < y_b + sp_b.height && y_a + sp_a.height > y_b)
+	{
+		return sprite_pixels_overlap(sp_a, x_a, y_a, sp_b, x_b, y_b);
+	}
+
+	return false;
+}
+
+bool sprite_pixels_overlap(const Sprite& sp_a, size_t x_a, size_t y_a, const Sprite& sp_b, size_t x_b, size_t y_b)
+{
+	// Positions may have wrapped around, their differences are still
+	// right once made signed. Overlapping rectangles are less than
+	// SPRITE_MAX_WIDTH apart, so either row fits shifted in 64 bits
+	ptrdiff_t dx = static_cast<ptrdiff_t>(x_b - x_a);
+	ptrdiff_t dy = static_cast<ptrdiff_t>(y_b - y_a);
+	unsigned shift_a = dx < 0 ? static_cast<unsigned>(-dx) : 0;
+	unsigned shift_b = dx > 0 ? static_cast<unsigned>(dx) : 0;
+
+	// Row 0 is the top one, so row r of a sprite is at height
+	// y + height - 1 - r, and row rb of B lines up with row rb + row_offset of A
+	ptrdiff_t height_a = static_cast<ptrdiff_t>(sp_a.height);
+	ptrdiff_t height_b = static_cast<ptrdiff_t>(sp_b.height);
+	ptrdiff_t row_offset = height_a - height_b - dy;
+	ptrdiff_t first_row = std::max(ptrdiff_t(0), row_offset);
+	ptrdiff_t last_row = std::min(height_a, height_b + row_offset);
+
+	for (ptrdiff_t ra = first_row; ra < last_row; ++ra)
+	{
+		uint64_t row_a = uint64_t(sp_a.rows[ra]) << shift_a;
+		uint64_t row_b = uint64_t(sp_b.rows[ra - row_offset]) << shift_b;
+		if (row_a & row_b) return true;
+	}
+
+	return false;
+}
+
+// The art of the built in sprites, packed into row masks by the compiler
+// so the tables live in read-only data and need no startup work
+static constexpr SpriteRows<8, 8> ALIEN_A0 = sprite_rows<8, 8>(
+	"...@@..."
+	"..@@@@.."
+	".@@@@@@."
+	"@@.@@.@@"
+	"@@@@@@@@"
+	".@.@@.@."
+	"@......@"
+	".@....@.");
+
+static constexpr SpriteRows<8, 8> ALIEN_A1 = sprite_rows<8, 8>(
+	"...@@..."
+	"..@@@@.."
+	".@@@@@@."
+	"@@.@@.@@"
+	"@@@@@@@@"
+	"..@..@.."
+	".@.@@.@."
+	"@.@..@.@");
+
+static constexpr SpriteRows<11, 8> ALIEN_B0 = sprite_rows<11, 8>(
+	"..@.....@.."
+	"...@...@..."
+	"..@@@@@@@.."
+	".@@.@@@.@@."
+	"@@@@@@@@@@@"
+	"@.@@@@@@@.@"
+	"@.@.....@.@"
+	"...@@.@@...");
+
+static constexpr SpriteRows<11, 8> ALIEN_B1 = sprite_rows<11, 8>(
+	"..@.....@.."
+	"@..@...@..@"
+	"@.@@@@@@@.@"
+	"@@@.@@@.@@@"
+	"@@@@@@@@@@@"
+	".@@@@@@@@@."
+	"..@.....@.."
+	".@.......@.");
+
+static constexpr SpriteRows<12, 8> ALIEN_C0 = sprite_rows<12, 8>(
+	"....@@@@...."
+	".@@@@@@@@@@."
+	"@@@@@@@@@@@@"
+	"@@@..@@..@@@"
+	"@@@@@@@@@@@@"
+	"...@@..@@..."
+	"..@@.@@.@@.."
+	"@@........@@");
+
+static constexpr SpriteRows<12, 8> ALIEN_C1 = sprite_rows<12, 8>(
+	"....@@@@...."
+	".@@@@@@@@@@."
+	"@@@@@@@@@@@@"
+	"@@@..@@..@@@"
+	"@@@@@@@@@@@@"
+	"..@@@..@@@.."
+	".@@..@@..@@."
+	"..@@....@@..");
+
+static constexpr SpriteRows<13, 7> ALIEN_DEATH = sprite_rows<13, 7>(
+	".@..@...@..@."
+	"..@..@.@..@.."
+	"...@.....@..."
+	"@@.........@@"
+	"...@.....@..."
+	"..@..@.@..@.."
+	".@..@...@..@.");
+
+static constexpr SpriteRows<11, 7> PLAYER = sprite_rows<11, 7>(
+	".....@....."
+	"....@@@...."
+	"....@@@...."
+	".@@@@@@@@@."
+	"@@@@@@@@@@@"
+	"@@@@@@@@@@@"
+	"@@@@@@@@@@@");
+
+static constexpr SpriteRows<1, 3> BULLET = sprite_rows<1, 3>(
+	"@"
+	"@"
+	"@");
+
+static constexpr Sprite ALIEN_SPRITES[6] = {
+	sprite_from_rows(ALIEN_A0), sprite_from_rows(ALIEN_A1),
+	sprite_from_rows(ALIEN_B0), sprite_from_rows(ALIEN_B1),
+	sprite_from_rows(ALIEN_C0), sprite_from_rows(ALIEN_C1)
+};
+
+struct GlyphArt
+{
+	char letter;
+	SpriteRows<GLYPH_WIDTH, GLYPH_HEIGHT> rows;
+};
+
+static constexpr GlyphArt GLYPH_ART[] = {
+	{ 'S', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@@@"
+		"@..."
+		".@@."
+		"...@"
+		"@@@.") },
+	{ 'C', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@@@"
+		"@..."
+		"@..."
+		"@..."
+		".@@@") },
+	{ 'O', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@@."
+		"@..@"
+		"@..@"
+		"@..@"
+		".@@.") },
+	{ 'R', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@..@"
+		"@@@."
+		"@.@."
+		"@..@") },
+	{ 'E', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@@"
+		"@..."
+		"@@@."
+		"@..."
+		"@@@@") },
+	{ 'A', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@@."
+		"@..@"
+		"@@@@"
+		"@..@"
+		"@..@") },
+	{ 'B', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@..@"
+		"@@@."
+		"@..@"
+		"@@@.") },
+	{ 'D', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@..@"
+		"@..@"
+		"@..@"
+		"@@@.") },
+	{ 'F', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@@"
+		"@..."
+		"@@@."
+		"@..."
+		"@...") },
+	{ 'G', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@@@"
+		"@..."
+		"@.@@"
+		"@..@"
+		".@@@") },
+	{ 'H', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@..@"
+		"@..@"
+		"@@@@"
+		"@..@"
+		"@..@") },
+	{ 'I', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		".@.."
+		".@.."
+		".@.."
+		"@@@.") },
+	{ 'L', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@..."
+		"@..."
+		"@..."
+		"@..."
+		"@@@@") },
+	{ 'M', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@..@"
+		"@@@@"
+		"@@@@"
+		"@..@"
+		"@..@") },
+	{ 'N', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@..@"
+		"@@.@"
+		"@.@@"
+		"@..@"
+		"@..@") },
+	{ 'P', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@..@"
+		"@@@."
+		"@..."
+		"@...") },
+	{ 'T', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		".@.."
+		".@.."
+		".@.."
+		".@..") },
+	{ 'U', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@..@"
+		"@..@"
+		"@..@"
+		"@..@"
+		".@@.") },
+	{ 'V', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@.@."
+		"@.@."
+		"@.@."
+		"@.@."
+		".@..") },
+	{ 'W', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@..@"
+		"@..@"
+		"@@@@"
+		"@@@@"
+		"@..@") },
+	{ 'Y', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@.@."
+		"@.@."
+		".@.."
+		".@.."
+		".@..") },
+	{ '0', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@.@."
+		"@.@."
+		"@.@."
+		"@@@.") },
+	{ '1', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@.."
+		".@.."
+		".@.."
+		".@.."
+		".@..") },
+	{ '2', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"..@."
+		"@@.."
+		"@..."
+		"@@@.") },
+	{ '3', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"..@."
+		".@.."
+		"..@."
+		"@@@.") },
+	{ '4', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@.@."
+		"@.@."
+		"@@@."
+		"..@."
+		"..@.") },
+	{ '5', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		".@@@"
+		".@.."
+		".@@."
+		"...@"
+		".@@.") },
+	{ '6', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@..."
+		"@@@."
+		"@.@."
+		"@@@.") },
+	{ '7', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"..@."
+		"..@."
+		"..@."
+		"..@.") },
+	{ '8', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@.@."
+		"@@@."
+		"@.@."
+		"@@@.") },
+	{ '9', sprite_rows<GLYPH_WIDTH, GLYPH_HEIGHT>(
+		"@@@."
+		"@.@."
+		"@@@."
+		"..@."
+		"..@.") }
+};
+
+static constexpr GlyphAtlas make_glyph_atlas()
+{
+	GlyphAtlas atlas = {};
+	for (size_t i = 0; i < GLYPH_ATLAS_SIZE; ++i)
+	{
+		atlas.glyphs[i] = Sprite{ GLYPH_WIDTH, GLYPH_HEIGHT, NULL };
+	}
+	for (const GlyphArt& glyph : GLYPH_ART)
+	{
+		atlas.glyphs[static_cast<uint8_t>(glyph.letter)] = sprite_from_rows(glyph.rows);
+	}
+	atlas.life_sprite = sprite_from_rows(PLAYER);
+	return atlas;
+}
+
+constexpr GameSprites BUILTIN_SPRITES = {
+	ALIEN_SPRITES,
+	sprite_from_rows(ALIEN_DEATH),
+	sprite_from_rows(PLAYER),
+	sprite_from_rows(BULLET)
+};
+
+constexpr GlyphAtlas BUILTIN_GLYPHS = make_glyph_atlas();
@@ -0,0 +1,67 @@
+#pragma once
+#include "Items.h"
+
+// Every sprite the game itself needs, shared by the simulation (for
+// collision sizes) and the renderer
+struct GameSprites
+{
+	const Sprite* alien_sprites;
+	Sprite alien_death_sprite;
+	Sprite player_sprite;
+	Sprite bullet_sprite;
+};
+
+#define GLYPH_ATLAS_SIZE 128
+#define GLYPH_WIDTH 4
+#define GLYPH_HEIGHT 5
+
+// Every glyph the game knows, indexed by character, plus the
+// player icon used for the lives counter. Glyphs that do not exist have
+// NULL data and rows
+struct GlyphAtlas
+{
+	Sprite glyphs[GLYPH_ATLAS_SIZE];
+	Sprite life_sprite;
+};
+
+// True when an opaque pixel of sprite A covers one of sprite B
+bool sprite_overlap_check(const Sprite& sp_a, size_t x_a, size_t y_a, const Sprite& sp_b, size_t x_b, size_t y_b);
+
+// The pixel part of sprite_overlap_check, for callers that already know
+// the rectangles overlap. ANDs the packed rows the sprites share
+bool sprite_pixels_overlap(const Sprite& sp_a, size_t x_a, size_t y_a, const Sprite& sp_b, size_t x_b, size_t y_b);
+
+// Row masks of a W x H sprite, packed at compile time from its art: one
+// character per pixel, '@' opaque and anything else transparent, top row
+// first. Art of the wrong size does not compile
+template <size_t W, size_t H>
+struct SpriteRows
+{
+	uint32_t rows[H];
+};
+
+template <size_t W, size_t H>
+constexpr SpriteRows<W, H> sprite_rows(const char (&art)[W * H + 1])
+{
+	static_assert(W <= SPRITE_MAX_WIDTH, "Sprite rows are packed in 32 bits");
+	SpriteRows<W, H> packed = {};
+	for (size_t yi = 0; yi < H; ++yi)
+	{
+		for (size_t xi = 0; xi < W; ++xi)
+		{
+			if (art[yi * W + xi] == '@') packed.rows[yi] |= 1u << xi;
+		}
+	}
+	return packed;
+}
+
+template <size_t W, size_t H>
+constexpr Sprite sprite_from_rows(const SpriteRows<W, H>& packed)
+{
+	return Sprite{ W, H, packed.rows };
+}
+
+// The sprites built into the executable, constant tables in read-only
+// data that are never created or destroyed
+extern const GameSprites BUILTIN_SPRITES;
+extern const GlyphAtlas BUILTIN_GLYPHS;
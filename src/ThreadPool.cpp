@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+
+// Takes indices from the thread's own queue, then from the others in turn
+static void run_tasks(ThreadPool* pool, size_t self)
+{
+	for (size_t i = 0; i < pool->num_threads; ++i)
+	{
+		ThreadPoolQueue& queue = pool->queues[(self + i) % pool->num_threads];
+		size_t index;
+		while ((index = queue.next.fetch_add(1, std::memory_order_relaxed)) < queue.end)
+		{
+			pool->task(pool->context, index);
+		}
+	}
+}
+
+static void run_worker(ThreadPool* pool, size_t self)
+{
+	size_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(pool->mutex);
+			pool->wake.wait(lock, [&]() { return pool->quit || pool->generation != generation; });
+			if (pool->quit) return;
+			generation = pool->generation;
+		}
+
+		run_tasks(pool, self);
+
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		if (--pool->busy == 0) pool->done.notify_one();
+	}
+}
+
+ThreadPool* CreateThreadPool(size_t num_threads) {
+	if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+	if (num_threads == 0) num_threads = 1;
+
+	ThreadPool* pool = new ThreadPool;
+	pool->num_threads = num_threads;
+	pool->queues = new ThreadPoolQueue[num_threads];
+	for (size_t i = 0; i < num_threads; ++i)
+	{
+		pool->queues[i].next.store(0, std::memory_order_relaxed);
+		pool->queues[i].end = 0;
+	}
+	pool->task = NULL;
+	pool->context = NULL;
+	pool->generation = 0;
+	pool->busy = 0;
+	pool->quit = false;
+
+	// Thread 0 is whichever thread calls thread_pool_run
+	pool->threads = new std::thread[num_threads - 1];
+	for (size_t i = 1; i < num_threads; ++i)
+	{
+		pool->threads[i - 1] = std::thread(run_worker, pool, i);
+	}
+	return pool;
+}
+
+void DestroyThreadPool(ThreadPool* pool) {
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->quit = true;
+	}
+	pool->wake.notify_all();
+	for (size_t i = 0; i + 1 < pool->num_threads; ++i)
+	{
+		pool->threads[i].join();
+	}
+	delete[] pool->threads;
+	delete[] pool->queues;
+	delete pool;
+}
+
+void thread_pool_run(ThreadPool* pool, size_t count, void (*task)(void* context, size_t index), void* context)
+{
+	if (count == 0) return;
+	if (pool->num_threads == 1 || count == 1)
+	{
+		for (size_t i = 0; i < count; ++i) task(context, i);
+		return;
+	}
+
+	pool->task = task;
+	pool->context = context;
+	for (size_t i = 0; i < pool->num_threads; ++i)
+	{
+		pool->queues[i].next.store(count * i / pool->num_threads, std::memory_order_relaxed);
+		pool->queues[i].end = count * (i + 1) / pool->num_threads;
+	}
+
+	// The lock publishes the queues and the task to the woken threads
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		++pool->generation;
+		pool->busy = pool->num_threads - 1;
+	}
+	pool->wake.notify_all();
+
+	run_tasks(pool, 0);
+
+	std::unique_lock<std::mutex> lock(pool->mutex);
+	pool->done.wait(lock, [&]() { return pool->busy == 0; });
+}
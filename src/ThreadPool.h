@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+// Indices of one thread's share of a loop. Padded to a cache line so the
+// threads taking indices do not slow each other down
+struct alignas(64) ThreadPoolQueue
+{
+	std::atomic<size_t> next;
+	size_t end;
+};
+
+// Runs parallel loops on a fixed set of threads, the calling one
+// included. The indices of a loop are split into one contiguous range per
+// thread; each thread works through its own range and, once it is empty,
+// steals indices from the others, so uneven tasks still keep every thread
+// busy. Taking an index is one atomic increment, there are no locks but
+// the ones waking the threads up
+struct ThreadPool
+{
+	size_t num_threads;
+	std::thread* threads;
+	ThreadPoolQueue* queues;
+
+	void (*task)(void* context, size_t index);
+	void* context;
+
+	std::mutex mutex;
+	std::condition_variable wake, done;
+	// Bumped for every loop, the threads wait for it to change
+	size_t generation;
+	size_t busy;
+	bool quit;
+};
+
+// num_threads counts the calling thread, 0 means one per hardware thread
+ThreadPool* CreateThreadPool(size_t num_threads);
+void DestroyThreadPool(ThreadPool* pool);
+
+// Calls task(context, i) for every i in [0, count), in any order and on
+// any thread of the pool, and returns once all of them returned
+void thread_pool_run(ThreadPool* pool, size_t count, void (*task)(void* context, size_t index), void* context);
+
+// Same for any callable taking the index
+template <typename Task>
+void thread_pool_for(ThreadPool* pool, size_t count, Task& task)
+{
+	thread_pool_run(pool, count, [](void* context, size_t index) { (*static_cast<Task*>(context))(index); }, &task);
+}
@@ -0,0 +1,33 @@
+#include <algorithm>
+#include "TickClock.h"
+
+TickClock CreateTickClock(double now) {
+	TickClock clock;
+	clock.accumulator = 0;
+	clock.previous_time = now;
+	return clock;
+}
+
+size_t tick_clock_take(TickClock* clock, double now)
+{
+	clock->accumulator += std::min(now - clock->previous_time, TICK_CLOCK_MAX_CATCH_UP);
+	clock->previous_time = now;
+
+	size_t ticks = 0;
+	while (clock->accumulator >= SIMULATION_DT)
+	{
+		clock->accumulator -= SIMULATION_DT;
+		++ticks;
+	}
+	return ticks;
+}
+
+float tick_clock_alpha(const TickClock& clock)
+{
+	return static_cast<float>(clock.accumulator / SIMULATION_DT);
+}
+
+double tick_clock_wait(const TickClock& clock)
+{
+	return SIMULATION_DT - clock.accumulator;
+}
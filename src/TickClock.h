@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include "Simulation.h"
+
+// When the ticks of the simulation are due in real time. The simulation
+// thread takes the ticks due and steps them whether or not the GL thread
+// has presented its last frame, so the game keeps SIMULATION_TICK_RATE
+// while frames are skipped
+//
+// Longest stretch of real time caught up at once, the rest is dropped
+// rather than played in a burst. Only a stall of the stepping thread
+// itself, a debugger or a suspended machine, gets that long
+#define TICK_CLOCK_MAX_CATCH_UP 0.25
+
+struct TickClock
+{
+	// Real time not simulated yet, and when the clock was last read, in seconds
+	double accumulator;
+	double previous_time;
+};
+
+TickClock CreateTickClock(double now);
+
+// Number of ticks due by now, in seconds, which are taken off the clock
+size_t tick_clock_take(TickClock* clock, double now);
+
+// How far the time taken last is past the last tick due, 0 to 1 of a tick,
+// for drawing in between ticks
+float tick_clock_alpha(const TickClock& clock);
+
+// Seconds from the time taken last until the next tick is due
+double tick_clock_wait(const TickClock& clock);
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include "TileRaster.h"
+#include "Fill.h"
+#include "Bits.h"
+
+void draw_list_clear(DrawList* list)
+{
+	list->count = 0;
+	list->overflow = false;
+}
+
+void draw_list_add(DrawList* list, const Sprite* sprite, ptrdiff_t x, ptrdiff_t y, ptrdiff_t width, ptrdiff_t height, uint32_t color)
+{
+	if (list->count == DRAW_LIST_MAX)
+	{
+		list->overflow = true;
+		return;
+	}
+
+	DrawCommand& command = list->commands[list->count++];
+	command.sprite = sprite;
+	command.x = x;
+	command.y = y;
+	command.width = width;
+	command.height = height;
+	command.color = color;
+}
+
+TileRasterizer* CreateTileRasterizer(size_t width, size_t height, size_t scale, ThreadPool* pool) {
+	TileRasterizer* rasterizer = new TileRasterizer;
+	rasterizer->width = width;
+	rasterizer->height = height;
+	rasterizer->scale = scale;
+	rasterizer->columns = (width * scale + TILE_SIZE - 1) / TILE_SIZE;
+	rasterizer->rows = (height * scale + TILE_SIZE - 1) / TILE_SIZE;
+	rasterizer->pool = pool;
+	rasterizer->tile_start = new uint32_t[rasterizer->columns * rasterizer->rows + 1];
+	rasterizer->tile_commands = NULL;
+	rasterizer->capacity = 0;
+	return rasterizer;
+}
+
+void DestroyTileRasterizer(TileRasterizer* rasterizer) {
+	delete[] rasterizer->tile_start;
+	delete[] rasterizer->tile_commands;
+	delete rasterizer;
+}
+
+// The command's rectangle in target pixels, clipped to the target.
+// Returns false when nothing of it is left
+static bool target_rect(const TileRasterizer* rasterizer, const DrawCommand& command,
+	ptrdiff_t& x0, ptrdiff_t& y0, ptrdiff_t& x1, ptrdiff_t& y1)
+{
+	ptrdiff_t scale = rasterizer->scale;
+	x0 = std::max(command.x * scale, ptrdiff_t(0));
+	y0 = std::max(command.y * scale, ptrdiff_t(0));
+	x1 = std::min((command.x + command.width) * scale, ptrdiff_t(rasterizer->width * scale));
+	y1 = std::min((command.y + command.height) * scale, ptrdiff_t(rasterizer->height * scale));
+	return x0 < x1 && y0 < y1;
+}
+
+static void draw_tile(const TileRasterizer* rasterizer, const DrawList* list, uint32_t* target, size_t tile)
+{
+	ptrdiff_t scale = rasterizer->scale;
+	ptrdiff_t stride = rasterizer->width * scale;
+	ptrdiff_t tile_x0 = (tile % rasterizer->columns) * TILE_SIZE;
+	ptrdiff_t tile_y0 = (tile / rasterizer->columns) * TILE_SIZE;
+	ptrdiff_t tile_x1 = std::min(tile_x0 + TILE_SIZE, stride);
+	ptrdiff_t tile_y1 = std::min(tile_y0 + TILE_SIZE, ptrdiff_t(rasterizer->height * scale));
+
+	for (uint32_t i = rasterizer->tile_start[tile]; i < rasterizer->tile_start[tile + 1]; ++i)
+	{
+		const DrawCommand& command = list->commands[rasterizer->tile_commands[i]];
+		ptrdiff_t x0, y0, x1, y1;
+		target_rect(rasterizer, command, x0, y0, x1, y1);
+		x0 = std::max(x0, tile_x0);
+		y0 = std::max(y0, tile_y0);
+		x1 = std::min(x1, tile_x1);
+		y1 = std::min(y1, tile_y1);
+
+		if (!command.sprite)
+		{
+			for (ptrdiff_t row = y0; row < y1; ++row)
+			{
+				fill_u32(target + row * stride + x0, x1 - x0, command.color);
+			}
+			continue;
+		}
+
+		// Sprite columns with at least one target pixel in the tile
+		ptrdiff_t left = command.x * scale;
+		ptrdiff_t first_column = (x0 - left) / scale;
+		ptrdiff_t columns = (x1 - 1 - left) / scale + 1 - first_column;
+		uint32_t column_mask = (columns >= 32 ? ~0u : (1u << columns) - 1) << first_column;
+
+		for (ptrdiff_t row = y0; row < y1; ++row)
+		{
+			// Sprite row 0 is the top one
+			ptrdiff_t yi = command.height - 1 - (row - command.y * scale) / scale;
+			uint32_t mask = command.sprite->rows[yi] & column_mask;
+			uint32_t* dst = target + row * stride;
+			while (mask)
+			{
+				ptrdiff_t column_x = left + count_trailing_zeros(mask) * scale;
+				std::fill(dst + std::max(column_x, x0), dst + std::min(column_x + scale, x1), command.color);
+				mask &= mask - 1;
+			}
+		}
+	}
+}
+
+void tile_raster_draw(TileRasterizer* rasterizer, const DrawList* list, uint32_t* target)
+{
+	size_t num_tiles = rasterizer->columns * rasterizer->rows;
+
+	// Everything before the last fill covering the whole buffer, normally
+	// the clear, is hidden by it
+	size_t first = 0;
+	for (size_t i = 0; i < list->count; ++i)
+	{
+		const DrawCommand& command = list->commands[i];
+		if (!command.sprite && command.x <= 0 && command.y <= 0 &&
+			command.x + command.width >= ptrdiff_t(rasterizer->width) &&
+			command.y + command.height >= ptrdiff_t(rasterizer->height)) first = i;
+	}
+
+	// Two passes like CreateCollisionGrid: count the commands of each
+	// tile, then scatter them in draw order into the ranges
+	std::fill(rasterizer->tile_start, rasterizer->tile_start + num_tiles + 1, 0);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (size_t i = first; i < list->count; ++i)
+		{
+			ptrdiff_t x0, y0, x1, y1;
+			if (!target_rect(rasterizer, list->commands[i], x0, y0, x1, y1)) continue;
+
+			size_t c0 = x0 / TILE_SIZE, c1 = (x1 - 1) / TILE_SIZE;
+			size_t r0 = y0 / TILE_SIZE, r1 = (y1 - 1) / TILE_SIZE;
+			for (size_t r = r0; r <= r1; ++r)
+			{
+				for (size_t c = c0; c <= c1; ++c)
+				{
+					if (pass == 0) ++rasterizer->tile_start[r * rasterizer->columns + c + 1];
+					else rasterizer->tile_commands[rasterizer->tile_start[r * rasterizer->columns + c]++] = static_cast<uint16_t>(i);
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (size_t tile = 0; tile < num_tiles; ++tile)
+			{
+				rasterizer->tile_start[tile + 1] += rasterizer->tile_start[tile];
+			}
+			if (rasterizer->tile_start[num_tiles] > rasterizer->capacity)
+			{
+				delete[] rasterizer->tile_commands;
+				rasterizer->capacity = rasterizer->tile_start[num_tiles];
+				rasterizer->tile_commands = new uint16_t[rasterizer->capacity];
+			}
+		}
+		else
+		{
+			for (size_t tile = num_tiles; tile > 0; --tile)
+			{
+				rasterizer->tile_start[tile] = rasterizer->tile_start[tile - 1];
+			}
+			rasterizer->tile_start[0] = 0;
+		}
+	}
+
+	auto task = [&](size_t tile) { draw_tile(rasterizer, list, target, tile); };
+	thread_pool_for(rasterizer->pool, num_tiles, task);
+}
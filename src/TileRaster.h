@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Items.h"
+#include "ThreadPool.h"
+
+#define DRAW_LIST_MAX 2048
+
+// One fill (sprite NULL) or sprite draw, in buffer coordinates with the
+// bottom left corner at (x, y)
+struct DrawCommand
+{
+	const Sprite* sprite;
+	ptrdiff_t x, y;
+	ptrdiff_t width, height;
+	uint32_t color;
+};
+
+// The draws of a frame, in order. A Buffer with a draw list records its
+// draws there instead of drawing them, for a TileRasterizer to draw later.
+// Draws past DRAW_LIST_MAX are dropped and set overflow
+struct DrawList
+{
+	DrawCommand commands[DRAW_LIST_MAX];
+	size_t count;
+	bool overflow;
+};
+
+void draw_list_clear(DrawList* list);
+void draw_list_add(DrawList* list, const Sprite* sprite, ptrdiff_t x, ptrdiff_t y, ptrdiff_t width, ptrdiff_t height, uint32_t color);
+
+// Side of the square tiles, in target pixels
+#define TILE_SIZE 64
+
+// Draws a draw list scale times larger than the buffer it was recorded
+// for, every buffer pixel becoming a scale x scale block. The commands
+// are binned into the tiles they cover, and the tiles drawn in parallel on
+// the pool, each by one thread from the first command to the last, so
+// tiles never share a pixel and need no synchronization
+struct TileRasterizer
+{
+	size_t width, height;
+	size_t scale;
+	size_t columns, rows;
+	ThreadPool* pool;
+	// Command indices of each tile, packed as ranges of one array like
+	// the cells of a CollisionGrid
+	uint32_t* tile_start;
+	uint16_t* tile_commands;
+	size_t capacity;
+};
+
+// width and height are those of the buffer the lists are recorded for
+TileRasterizer* CreateTileRasterizer(size_t width, size_t height, size_t scale, ThreadPool* pool);
+void DestroyTileRasterizer(TileRasterizer* rasterizer);
+
+// target is width * scale by height * scale pixels, laid out like a Buffer
+void tile_raster_draw(TileRasterizer* rasterizer, const DrawList* list, uint32_t* target);
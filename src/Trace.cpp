@@ -0,0 +1,97 @@
+#include <cstdio>
+#include "Trace.h"
+
+TraceRing* trace_ring = NULL;
+
+// Set in a slot's sequence while its writer fills it in
+#define TRACE_WRITING (uint64_t(1) << 63)
+
+TraceRing* CreateTraceRing() {
+	TraceRing* ring = new TraceRing;
+	for (size_t i = 0; i < TRACE_RING_SIZE; ++i)
+	{
+		ring->events[i].sequence.store(0, std::memory_order_relaxed);
+	}
+	ring->next.store(0, std::memory_order_relaxed);
+	ring->origin = PhaseClock::now();
+	return ring;
+}
+
+// Small stable ids read better in the viewer than OS thread ids
+static uint32_t trace_thread_id()
+{
+	static std::atomic<uint32_t> next_id(1);
+	thread_local uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+	return id;
+}
+
+static void trace_record(TraceRing* ring, char type, const char* name, PhaseClock::time_point start, PhaseClock::duration duration)
+{
+	uint64_t index = ring->next.fetch_add(1, std::memory_order_relaxed);
+	uint64_t sequence = index + 1;
+	TraceEvent& event = ring->events[index & (TRACE_RING_SIZE - 1)];
+
+	// Claim the slot, marking it as being written until the sequence is
+	// published. A writer stalled for a whole lap of the ring would
+	// otherwise overwrite a newer event with its older one, so the newer
+	// event always wins and the older one is dropped
+	uint64_t seen = event.sequence.load(std::memory_order_relaxed);
+	do
+	{
+		if ((seen & ~TRACE_WRITING) >= sequence) return;
+	} while (!event.sequence.compare_exchange_weak(seen, sequence | TRACE_WRITING, std::memory_order_relaxed));
+	std::atomic_thread_fence(std::memory_order_release);
+	event.name = name;
+	event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - ring->origin).count();
+	event.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	event.thread = trace_thread_id();
+	event.type = type;
+	// Fails when a newer writer took the slot over meanwhile
+	uint64_t claimed = sequence | TRACE_WRITING;
+	event.sequence.compare_exchange_strong(claimed, sequence, std::memory_order_release, std::memory_order_relaxed);
+}
+
+void trace_complete(TraceRing* ring, const char* name, PhaseClock::time_point start, PhaseClock::time_point end)
+{
+	trace_record(ring, 'X', name, start, end - start);
+}
+
+void trace_instant(TraceRing* ring, const char* name)
+{
+	trace_record(ring, 'i', name, PhaseClock::now(), PhaseClock::duration::zero());
+}
+
+bool trace_write_json(TraceRing* ring, const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file) return false;
+
+	uint64_t end = ring->next.load(std::memory_order_acquire);
+	uint64_t begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	for (uint64_t index = begin; index < end; ++index)
+	{
+		TraceEvent& slot = ring->events[index & (TRACE_RING_SIZE - 1)];
+
+		// Copy the event, then check nobody started rewriting it meanwhile
+		if (slot.sequence.load(std::memory_order_acquire) != index + 1) continue;
+		const char* name = slot.name;
+		uint64_t start_ns = slot.start_ns;
+		uint64_t duration_ns = slot.duration_ns;
+		uint32_t thread = slot.thread;
+		char type = slot.type;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != index + 1) continue;
+
+		fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+			first ? "" : ",\n", name, type, thread, start_ns / 1e3);
+		if (type == 'X') fprintf(file, ",\"dur\":%.3f}", duration_ns / 1e3);
+		else fprintf(file, ",\"s\":\"t\"}");
+		first = false;
+	}
+	fprintf(file, "\n]}\n");
+
+	return fclose(file) == 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+typedef std::chrono::steady_clock PhaseClock;
+
+// Power of two, the oldest events are overwritten once it is full
+#define TRACE_RING_SIZE (1 << 16)
+
+// One Chrome trace event: a complete event ('X') with its begin time and
+// duration, or an instant event ('i'). Names must be string literals,
+// only the pointer is stored
+struct TraceEvent
+{
+	std::atomic<uint64_t> sequence;
+	const char* name;
+	uint64_t start_ns;
+	uint64_t duration_ns;
+	uint32_t thread;
+	char type;
+};
+
+// Lock-free ring any thread can record into. A writer claims a slot with
+// one atomic increment and publishes it by storing the event's sequence
+// number, so a reader can tell finished events from overwritten or
+// half-written ones
+struct TraceRing
+{
+	TraceEvent events[TRACE_RING_SIZE];
+	std::atomic<uint64_t> next;
+	PhaseClock::time_point origin;
+};
+
+// The ring the game records into, NULL when it is not tracing
+extern TraceRing* trace_ring;
+
+TraceRing* CreateTraceRing();
+
+void trace_complete(TraceRing* ring, const char* name, PhaseClock::time_point start, PhaseClock::time_point end);
+void trace_instant(TraceRing* ring, const char* name);
+
+// Writes the events still in the ring as Chrome Trace Event JSON, which
+// chrome://tracing and Perfetto open. Returns false when the file can
+// not be written
+bool trace_write_json(TraceRing* ring, const char* path);
+
+// Records a complete event for its lifetime when tracing is on, for
+// wrapping single GL calls
+struct ScopedTrace
+{
+	const char* name;
+	PhaseClock::time_point start;
+
+	explicit ScopedTrace(const char* name) : name(name)
+	{
+		if (trace_ring) start = PhaseClock::now();
+	}
+
+	~ScopedTrace()
+	{
+		if (trace_ring) trace_complete(trace_ring, name, start, PhaseClock::now());
+	}
+
+	ScopedTrace(const ScopedTrace&) = delete;
+	ScopedTrace& operator=(const ScopedTrace&) = delete;
+};
@@ -0,0 +1,57 @@
+#include "TripleBuffer.h"
+
+TripleBuffer* CreateTripleBuffer(size_t width, size_t height) {
+	TripleBuffer* triple_buffer = new TripleBuffer;
+	for (size_t i = 0; i < 3; ++i)
+	{
+		Frame& frame = triple_buffer->frames[i];
+		frame.buffer.width = width;
+		frame.buffer.height = height;
+		frame.buffer.data = new uint32_t[width * height];
+		frame.buffer.dirty = NULL;
+		frame.buffer.draws = NULL;
+		frame.num_rects = 0;
+		frame.num_instances = 0;
+		frame.sequence = 0;
+		frame.brightness = 1.0f;
+	}
+	triple_buffer->back = 0;
+	triple_buffer->middle.store(1, std::memory_order_relaxed);
+	triple_buffer->front = 2;
+	return triple_buffer;
+}
+
+void DestroyTripleBuffer(TripleBuffer* triple_buffer) {
+	for (size_t i = 0; i < 3; ++i)
+	{
+		delete[] triple_buffer->frames[i].buffer.data;
+	}
+	delete triple_buffer;
+}
+
+Frame* triple_buffer_back(TripleBuffer* triple_buffer)
+{
+	return &triple_buffer->frames[triple_buffer->back];
+}
+
+void triple_buffer_publish(TripleBuffer* triple_buffer)
+{
+	// Release makes the frame's contents visible to the consumer, acquire
+	// makes sure it is done reading the frame we get back
+	uint8_t previous = triple_buffer->middle.exchange(triple_buffer->back | TRIPLE_BUFFER_FRESH, std::memory_order_acq_rel);
+	triple_buffer->back = previous & (TRIPLE_BUFFER_FRESH - 1);
+}
+
+bool triple_buffer_pending(const TripleBuffer* triple_buffer)
+{
+	return (triple_buffer->middle.load(std::memory_order_relaxed) & TRIPLE_BUFFER_FRESH) != 0;
+}
+
+const Frame* triple_buffer_acquire(TripleBuffer* triple_buffer)
+{
+	if (!triple_buffer_pending(triple_buffer)) return NULL;
+
+	uint8_t previous = triple_buffer->middle.exchange(triple_buffer->front, std::memory_order_acq_rel);
+	triple_buffer->front = previous & (TRIPLE_BUFFER_FRESH - 1);
+	return &triple_buffer->frames[triple_buffer->front];
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Items.h"
+#include "Dirty.h"
+#include "SpriteAtlas.h"
+
+// A finished frame handed from the thread that draws it to the thread
+// that presents it: pixels for the CPU backend, with rectangles of what
+// changed since the frame numbered sequence - 1, or instances for the GPU one
+struct Frame
+{
+	Buffer buffer;
+	DirtyRect rects[DIRTY_MAX_RECTS];
+	size_t num_rects;
+	SpriteInstance instances[DRAW_LIST_MAX];
+	size_t num_instances;
+	uint64_t sequence;
+	float brightness;
+};
+
+// Lock-free handoff between one producer and one consumer. The producer
+// draws into the back frame and publishes it by swapping it with the
+// middle one; the consumer takes the middle frame if it is newer than its
+// front one. Neither side ever waits for the other, and the consumer
+// always gets the newest finished frame, skipping the ones it was too
+// slow for. The producer can skip drawing while its last frame is pending
+#define TRIPLE_BUFFER_FRESH 4
+
+struct TripleBuffer
+{
+	Frame frames[3];
+	// Index of the middle frame, plus TRIPLE_BUFFER_FRESH once the
+	// producer published it and until the consumer takes it
+	std::atomic<uint8_t> middle;
+	// Only touched by the producer, and by the consumer respectively
+	uint8_t back, front;
+};
+
+TripleBuffer* CreateTripleBuffer(size_t width, size_t height);
+void DestroyTripleBuffer(TripleBuffer* triple_buffer);
+
+// Producer side
+Frame* triple_buffer_back(TripleBuffer* triple_buffer);
+void triple_buffer_publish(TripleBuffer* triple_buffer);
+// True while the last published frame has not been taken yet
+bool triple_buffer_pending(const TripleBuffer* triple_buffer);
+
+// Consumer side, returns NULL when nothing new was published
+const Frame* triple_buffer_acquire(TripleBuffer* triple_buffer);
@@ -59,7 +59,7 @@ static unsigned int CompileShader(unsigned int type, const std::string& source)
     if (result == GL_FALSE) {
         int length;
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
+        char* message = new char[length];
         glGetShaderInfoLog(id, length, &length, message);
 
         if (type == GL_VERTEX_SHADER) {
@@ -70,6 +70,7 @@ static unsigned int CompileShader(unsigned int type, const std::string& source)
         }
 
         std::cout << message << std::endl;
+        delete[] message;
         glDeleteShader(id);
         return 0;
     }
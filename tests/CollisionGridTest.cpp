@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstdlib>
+#include "../src/CollisionGrid.h"
+#include "../src/Sprites.h"
+
+// Builds grids over the game's formation and over scattered aliens, then
+// checks random queries against a brute-force rectangle test: every alien
+// overlapping the query must be visited, and every alien visited must
+// reach into a cell the query covers
+static bool check_grid(const char* name, const int16_t* x, const int16_t* y, const uint8_t* type, size_t num_aliens)
+{
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	CollisionGrid grid = CreateCollisionGrid(x, y, type, num_aliens, sprites.alien_sprites);
+	const ptrdiff_t cell = COLLISION_GRID_CELL_SIZE;
+	bool ok = true;
+
+	for (size_t q = 0; q < 20000 && ok; ++q)
+	{
+		ptrdiff_t x0 = rand() % 300 - 40, y0 = rand() % 340 - 40;
+		ptrdiff_t x1 = x0 + 1 + rand() % 40, y1 = y0 + 1 + rand() % 40;
+
+		uint64_t visited = 0;
+		collision_grid_visit(grid, x0, y0, x1, y1, [&](size_t ai) { visited |= uint64_t(1) << ai; });
+
+		for (size_t ai = 0; ai < num_aliens; ++ai)
+		{
+			const Sprite& sprite = sprites.alien_sprites[2 * (type[ai] - 1)];
+			ptrdiff_t ax0 = x[ai], ay0 = y[ai];
+			ptrdiff_t ax1 = ax0 + sprite.width, ay1 = ay0 + sprite.height;
+			bool overlaps = x0 < ax1 && ax0 < x1 && y0 < ay1 && ay0 < y1;
+
+			// The query shares a cell with the alien when it overlaps the
+			// alien grown to whole cells
+			ptrdiff_t cx0 = grid.origin_x + (ax0 - grid.origin_x) / cell * cell;
+			ptrdiff_t cy0 = grid.origin_y + (ay0 - grid.origin_y) / cell * cell;
+			ptrdiff_t cx1 = grid.origin_x + (ax1 - grid.origin_x + cell - 1) / cell * cell;
+			ptrdiff_t cy1 = grid.origin_y + (ay1 - grid.origin_y + cell - 1) / cell * cell;
+			bool shares_cell = x0 < cx1 && cx0 < x1 && y0 < cy1 && cy0 < y1;
+
+			bool was_visited = (visited >> ai) & 1;
+			if ((overlaps && !was_visited) || (was_visited && !shares_cell))
+			{
+				fprintf(stderr, "%s: query [%td, %td) x [%td, %td) %s alien %zu at %td, %td\n", name, x0, x1, y0, y1,
+					was_visited ? "visited the far" : "missed the overlapping", ai, ax0, ay0);
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	DestroyCollisionGrid(grid);
+	return ok;
+}
+
+int main() {
+	const size_t num_aliens = 55;
+	int16_t x[GAME_MAX_ALIENS], y[GAME_MAX_ALIENS];
+	uint8_t type[GAME_MAX_ALIENS];
+	int failures = 0;
+
+	// The formation as the game lays it out
+	for (size_t yi = 0; yi < 5; ++yi)
+	{
+		for (size_t xi = 0; xi < 11; ++xi)
+		{
+			size_t ai = yi * 11 + xi;
+			type[ai] = static_cast<uint8_t>((5 - yi) / 2 + 1);
+			x[ai] = static_cast<int16_t>(19 + xi * 17);
+			y[ai] = static_cast<int16_t>(17 * yi + 128);
+		}
+	}
+	if (!check_grid("Formation", x, y, type, num_aliens)) ++failures;
+
+	// Aliens anywhere, overlapping each other and the cell borders
+	for (size_t round = 0; round < 50; ++round)
+	{
+		for (size_t ai = 0; ai < num_aliens; ++ai)
+		{
+			type[ai] = static_cast<uint8_t>(1 + rand() % 3);
+			x[ai] = static_cast<int16_t>(rand() % 220);
+			y[ai] = static_cast<int16_t>(rand() % 250);
+		}
+		if (!check_grid("Scattered", x, y, type, num_aliens)) ++failures;
+	}
+
+	return failures ? 1 : 0;
+}
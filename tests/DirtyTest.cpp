@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../src/Render.h"
+
+// Draws a scene frame after frame while sprites are inserted, removed,
+// moved, recolored and reordered, and copies only the rectangles the
+// tracker reports onto the previous frame. That copy must equal the new
+// frame pixel for pixel, including when a frame has more draws than the
+// tracker records and it falls back to the whole frame
+struct Draw
+{
+	const Sprite* sprite;
+	ptrdiff_t x, y;
+	uint32_t color;
+};
+
+static Draw random_draw(const GameSprites& sprites, size_t width, size_t height)
+{
+	const Sprite* candidates[] = {
+		&sprites.alien_sprites[0], &sprites.alien_sprites[2], &sprites.alien_sprites[5],
+		&sprites.alien_death_sprite, &sprites.player_sprite, &sprites.bullet_sprite,
+	};
+	Draw draw;
+	draw.sprite = candidates[rand() % 6];
+	// Partly off every edge now and then
+	draw.x = rand() % (width + 20) - 10;
+	draw.y = rand() % (height + 20) - 10;
+	draw.color = 0xFF000000 | (rand() % 4) * 0x404040;
+	return draw;
+}
+
+static void draw_scene(Buffer* buffer, const std::vector<Draw>& scene)
+{
+	dirty_begin_frame(buffer->dirty);
+	buffer_clear(buffer, 0x00800000);
+	for (const Draw& draw : scene)
+	{
+		buffer_draw_sprite(buffer, *draw.sprite, draw.x, draw.y, draw.color);
+	}
+	dirty_end_frame(buffer->dirty, buffer->width, buffer->height);
+}
+
+static void mutate(std::vector<Draw>& scene, const GameSprites& sprites, size_t width, size_t height, size_t changes)
+{
+	for (size_t c = 0; c < changes; ++c)
+	{
+		size_t i = scene.empty() ? 0 : rand() % scene.size();
+		switch (scene.empty() ? 0 : rand() % 5)
+		{
+		case 0: scene.insert(scene.begin() + i, random_draw(sprites, width, height)); break;
+		case 1: scene.erase(scene.begin() + i); break;
+		case 2: scene[i].x += rand() % 5 - 2; scene[i].y += rand() % 5 - 2; break;
+		case 3: scene[i].color ^= 0x404040; break;
+		case 4: std::swap(scene[i], scene[rand() % scene.size()]); break;
+		}
+	}
+}
+
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	const size_t width = 224, height = 256;
+	Buffer buffer;
+	buffer.width = width;
+	buffer.height = height;
+	buffer.data = new uint32_t[width * height];
+	buffer.dirty = CreateDirtyTracker();
+	buffer.draws = NULL;
+	uint32_t* shown = new uint32_t[width * height];
+	memset(shown, 0, width * height * sizeof(uint32_t));
+
+	std::vector<Draw> scene;
+	for (size_t i = 0; i < 80; ++i) scene.push_back(random_draw(sprites, width, height));
+
+	int failures = 0;
+	bool overflowed = false;
+	size_t partial = 0;
+	for (size_t frame = 0; frame < 3000 && !failures; ++frame)
+	{
+		// Mostly a few changes, sometimes many, and a stretch of frames
+		// with more draws than the tracker holds. Leaving it, the draws it
+		// did record are all still there, only the last ones went away
+		size_t phase = frame % 500;
+		if (phase == 250)
+		{
+			while (scene.size() < DIRTY_MAX_RECORDS + 8) scene.push_back(random_draw(sprites, width, height));
+		}
+		else if (phase == 255) scene.resize(DIRTY_MAX_RECORDS - 1);
+		else if (phase == 260) scene.resize(80);
+		else if (phase < 250 || phase > 260) mutate(scene, sprites, width, height, frame % 37 == 0 ? 40 : rand() % 4);
+
+		draw_scene(&buffer, scene);
+		const DirtyTracker& tracker = *buffer.dirty;
+		bool whole = tracker.num_rects == 1 && tracker.rects[0].width == ptrdiff_t(width) && tracker.rects[0].height == ptrdiff_t(height);
+		if (!whole) ++partial;
+		if (scene.size() + 1 > DIRTY_MAX_RECORDS)
+		{
+			overflowed = true;
+			if (!whole)
+			{
+				fprintf(stderr, "Frame %zu: %zu draws did not make the whole frame dirty\n", frame, scene.size());
+				++failures;
+			}
+		}
+		if (tracker.num_rects > DIRTY_MAX_RECTS)
+		{
+			fprintf(stderr, "Frame %zu: %zu rectangles\n", frame, tracker.num_rects);
+			++failures;
+			break;
+		}
+
+		buffer_copy_rects(&buffer, shown, tracker.rects, tracker.num_rects);
+		for (size_t p = 0; p < width * height; ++p)
+		{
+			if (shown[p] != buffer.data[p])
+			{
+				fprintf(stderr, "Frame %zu: pixel %zu, %zu is %08x after the upload instead of %08x\n",
+					frame, p % width, p / width, shown[p], buffer.data[p]);
+				++failures;
+				break;
+			}
+		}
+	}
+	// Most frames must have been diffed, not uploaded whole
+	if (!overflowed || partial < 2000)
+	{
+		fprintf(stderr, "%zu frames uploaded in part, %s the tracker overflowing\n", partial, overflowed ? "with" : "without");
+		++failures;
+	}
+
+	delete buffer.dirty;
+	delete[] shown;
+	delete[] buffer.data;
+	return failures ? 1 : 0;
+}
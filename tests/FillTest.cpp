@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <cstring>
+#include "../src/Fill.h"
+
+// Runs every fill kernel the CPU supports at each start offset within a
+// 64-byte line and every length up to 70, against the scalar kernel. The
+// span must hold the value and the guard words around it stay untouched
+#define GUARD_WORDS 16
+#define GUARD_VALUE 0xDEADBEEFu
+
+struct NamedKernel
+{
+	const char* name;
+	FillKernel kernel;
+};
+
+int main() {
+	NamedKernel kernels[] = {
+#ifdef FILL_HAS_X86_KERNELS
+		{ "sse2", fill_u32_sse2 },
+		{ "avx2", cpu_has_avx2() ? fill_u32_avx2 : NULL },
+#endif
+		{ fill_kernel_name(), fill_u32 },
+	};
+	const size_t max_count = 70;
+	const size_t size = GUARD_WORDS + 16 + max_count + GUARD_WORDS;
+	// Aligned to a cache line, so the offsets below give every alignment
+	alignas(64) uint32_t expected[size];
+	alignas(64) uint32_t actual[size];
+	int failures = 0;
+
+	for (const NamedKernel& k : kernels)
+	{
+		if (!k.kernel) continue;
+		for (size_t offset = 0; offset < 16; ++offset)
+		{
+			for (size_t count = 0; count <= max_count; ++count)
+			{
+				uint32_t value = 0x01000000u * uint32_t(count) + uint32_t(offset);
+				for (size_t i = 0; i < size; ++i) expected[i] = actual[i] = GUARD_VALUE;
+				fill_u32_scalar(expected + GUARD_WORDS + offset, count, value);
+				k.kernel(actual + GUARD_WORDS + offset, count, value);
+
+				for (size_t i = 0; i < size; ++i)
+				{
+					if (actual[i] != expected[i])
+					{
+						fprintf(stderr, "%s: filling %zu words at offset %zu left word %td as %08x instead of %08x\n",
+							k.name, count, offset, ptrdiff_t(i) - ptrdiff_t(GUARD_WORDS + offset), actual[i], expected[i]);
+						++failures;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	// The scalar kernel is the reference, check it fills exactly the span
+	for (size_t i = 0; i < size; ++i) expected[i] = GUARD_VALUE;
+	fill_u32_scalar(expected + GUARD_WORDS + 3, max_count, 7);
+	for (size_t i = 0; i < size; ++i)
+	{
+		bool inside = i >= GUARD_WORDS + 3 && i < GUARD_WORDS + 3 + max_count;
+		if (expected[i] != (inside ? 7u : GUARD_VALUE))
+		{
+			fprintf(stderr, "scalar: word %zu is %08x\n", i, expected[i]);
+			++failures;
+			break;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
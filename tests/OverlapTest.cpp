@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <cstdlib>
+#include "../src/Overlap.h"
+
+// The batch kernels against one sprite_overlap_check style rectangle test
+// per rectangle, on random formations that include negative positions
+static uint64_t reference_mask(const OverlapBatch& batch, size_t x, size_t y, size_t width, size_t height)
+{
+	uint64_t mask = 0;
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		size_t bx = static_cast<size_t>(static_cast<ptrdiff_t>(batch.x[i]));
+		size_t by = static_cast<size_t>(static_cast<ptrdiff_t>(batch.y[i]));
+		if (x < bx + batch.width[i] && x + width > bx &&
+			y < by + batch.height[i] && y + height > by)
+		{
+			mask |= uint64_t(1) << i;
+		}
+	}
+	return mask;
+}
+
+int main() {
+	int16_t x[64], y[64], width[64], height[64];
+	int16_t screen_x[64], screen_y[64], scalar_x[64], scalar_y[64];
+	srand(1);
+
+	for (int iteration = 0; iteration < 100000; ++iteration)
+	{
+		size_t count = 1 + rand() % 64;
+		for (size_t i = 0; i < 64; ++i)
+		{
+			x[i] = rand() % 300 - 40;
+			y[i] = rand() % 300 - 40;
+			width[i] = rand() % 14;
+			height[i] = rand() % 10;
+		}
+
+		float offset_x = (rand() % 400 - 200) * 0.125f;
+		float offset_y = (rand() % 400 - 200) * 0.5f;
+		size_t padded = (count + OVERLAP_LANES - 1) / OVERLAP_LANES * OVERLAP_LANES;
+		overlap_translate(screen_x, x, padded, offset_x);
+		overlap_translate(screen_y, y, padded, offset_y);
+		overlap_translate_scalar(scalar_x, x, count, offset_x);
+		overlap_translate_scalar(scalar_y, y, count, offset_y);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (screen_x[i] != scalar_x[i] || screen_y[i] != scalar_y[i] ||
+				screen_x[i] != static_cast<int16_t>(x[i] + offset_x))
+			{
+				fprintf(stderr, "overlap_translate differs at %zu\n", i);
+				return 1;
+			}
+		}
+
+		OverlapBatch batch = { screen_x, screen_y, width, height, count };
+		size_t ax = rand() % 256, ay = rand() % 256;
+		size_t aw = 1 + rand() % 12, ah = 1 + rand() % 8;
+
+		uint64_t expected = reference_mask(batch, ax, ay, aw, ah);
+		uint64_t got = overlap_mask(batch, ax, ay, aw, ah);
+		uint64_t got_scalar = overlap_mask_scalar(batch, ax, ay, aw, ah);
+		if (got != expected || got_scalar != expected)
+		{
+			fprintf(stderr, "overlap_mask %llx, scalar %llx, expected %llx\n",
+				(unsigned long long)got, (unsigned long long)got_scalar, (unsigned long long)expected);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,47 @@
+#include <cstdio>
+#include "../src/PhaseTimers.h"
+
+// Times the simulation phases in one frame out of three, as when drawing
+// faster than the game ticks, and a drawing phase in every frame. The
+// statistics of a phase must only cover the frames that ran it
+int main() {
+	PhaseTimers* timers = CreatePhaseTimers("test");
+	int failures = 0;
+
+	for (size_t frame = 0; frame < 600; ++frame)
+	{
+		phase_timers_add(timers, PHASE_CLEAR, std::chrono::microseconds(10));
+		if (frame % 3 == 0)
+		{
+			// Two ticks in this frame, 20 and 30 us of bullets
+			phase_timers_add(timers, PHASE_BULLET_SIM, std::chrono::microseconds(20 + frame % 2 * 10));
+			phase_timers_add(timers, PHASE_BULLET_SIM, std::chrono::microseconds(20 + frame % 2 * 10));
+		}
+		phase_timers_end_frame(timers);
+	}
+
+	PhaseStats bullets = phase_timers_stats(timers, PHASE_BULLET_SIM);
+	if (phase_timers_window(timers, PHASE_BULLET_SIM) != 200 || bullets.min_us != 40 || bullets.avg_us != 50 || bullets.p99_us != 60)
+	{
+		fprintf(stderr, "Bullets over %zu frames: min %.3f, avg %.3f, p99 %.3f us\n",
+			phase_timers_window(timers, PHASE_BULLET_SIM), bullets.min_us, bullets.avg_us, bullets.p99_us);
+		++failures;
+	}
+
+	PhaseStats clear = phase_timers_stats(timers, PHASE_CLEAR);
+	if (phase_timers_window(timers, PHASE_CLEAR) != PHASE_TIMER_HISTORY || clear.min_us != 10 || clear.p99_us != 10)
+	{
+		fprintf(stderr, "Clear over %zu frames: min %.3f, p99 %.3f us\n", phase_timers_window(timers, PHASE_CLEAR), clear.min_us, clear.p99_us);
+		++failures;
+	}
+
+	// Never timed, no samples
+	if (phase_timers_window(timers, PHASE_SWAP) != 0 || phase_timers_recorded(timers, PHASE_SWAP))
+	{
+		fprintf(stderr, "Swap has %zu samples\n", phase_timers_window(timers, PHASE_SWAP));
+		++failures;
+	}
+
+	delete timers;
+	return failures ? 1 : 0;
+}
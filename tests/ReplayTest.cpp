@@ -0,0 +1,219 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../src/Replay.h"
+
+// Records bot games, then checks the inputs read back tick for tick, that
+// re-simulating the replays passes through every keyframe and ends in the
+// recorded state, and that seeking gives the same state as simulating
+// from the start
+static const char* path = "ReplayTest.replay";
+
+// The bot turns every 0.3 s in a fixed pattern, depending on the seed
+static Input bot_input(size_t t, uint32_t seed)
+{
+	Input input;
+	input.move_dir = static_cast<int>(((t / (SIMULATION_TICK_RATE * 3 / 10)) * 7 + seed) % 3) - 1;
+	input.fire = (t % (SIMULATION_TICK_RATE / 3) == 0);
+	return input;
+}
+
+// Plays and records a game, keeping the state before every tick
+static bool record_game(const GameSprites& sprites, uint32_t seed, size_t ticks,
+	std::vector<Input>& inputs, std::vector<Game>& states)
+{
+	ReplayRecorder* recorder = CreateReplayRecorder(path, seed);
+	if (!recorder) return false;
+	Simulation* sim = new Simulation(sprites, seed);
+
+	for (size_t t = 0; t < ticks; ++t)
+	{
+		Input input = bot_input(t, seed);
+		states.push_back(sim->game);
+		replay_record(recorder, *sim, input);
+		sim->step(input);
+		inputs.push_back(input);
+	}
+	states.push_back(sim->game);
+
+	bool written = replay_recorder_finish(recorder, *sim);
+	DestroyReplayRecorder(recorder);
+	delete sim;
+	return written;
+}
+
+static bool write_bytes(const std::vector<uint8_t>& bytes)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file) return false;
+	fwrite(bytes.data(), 1, bytes.size(), file);
+	return fclose(file) == 0;
+}
+
+static std::vector<uint8_t> read_bytes()
+{
+	std::vector<uint8_t> bytes;
+	FILE* file = fopen(path, "rb");
+	if (!file) return bytes;
+	int c;
+	while ((c = fgetc(file)) != EOF) bytes.push_back(static_cast<uint8_t>(c));
+	fclose(file);
+	return bytes;
+}
+
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	int failures = 0;
+
+	// Games past game over, a single chunk, a whole number of chunks and
+	// an empty one
+	const size_t lengths[] = { 20000, 100, 4 * REPLAY_KEYFRAME_INTERVAL, 0 };
+	for (uint32_t seed = 1; seed <= 4; ++seed)
+	{
+		size_t ticks = lengths[seed - 1];
+		std::vector<Input> inputs;
+		std::vector<Game> states;
+		if (!record_game(sprites, seed, ticks, inputs, states))
+		{
+			fprintf(stderr, "Could not write %s\n", path);
+			return 1;
+		}
+
+		Replay replay;
+		if (!LoadReplay(path, &replay))
+		{
+			fprintf(stderr, "Seed %u: could not load the replay back\n", seed);
+			return 1;
+		}
+
+		ReplayCursor cursor = replay_begin(&replay);
+		Input input;
+		size_t t = 0;
+		while (replay_next(&cursor, &input))
+		{
+			if (t >= ticks || input.move_dir != inputs[t].move_dir || input.fire != inputs[t].fire)
+			{
+				fprintf(stderr, "Seed %u: input of tick %zu differs\n", seed, t);
+				++failures;
+				break;
+			}
+			++t;
+		}
+		if (t != ticks) fprintf(stderr, "Seed %u: %zu ticks read back of %zu\n", seed, t, ticks), ++failures;
+
+		size_t first_mismatch;
+		ReplayResult replayed = replay_simulate(&replay, sprites, &first_mismatch);
+		if (first_mismatch != SIZE_MAX || !replay_results_equal(replayed, replay.footer->result))
+		{
+			fprintf(stderr, "Seed %u: re-simulation differs from tick %zu, recorded score %llu, replayed %llu\n", seed,
+				first_mismatch, (unsigned long long)replay.footer->result.score, (unsigned long long)replayed.score);
+			++failures;
+		}
+
+		// Seeking anywhere, keyframe ticks and the last one included, gives
+		// the state of the straight run and the input that came next
+		const size_t seeks[] = { 0, 1, REPLAY_KEYFRAME_INTERVAL - 1, REPLAY_KEYFRAME_INTERVAL, 3 * REPLAY_KEYFRAME_INTERVAL + 17, ticks / 2, ticks };
+		Simulation* sim = new Simulation(sprites, 99);
+		for (size_t target : seeks)
+		{
+			if (target > ticks) continue;
+			ReplayCursor at = replay_seek(&replay, sim, target);
+			bool has_input = replay_next(&at, &input);
+			if (memcmp(&sim->game, &states[target], sizeof(Game)) != 0 ||
+				has_input != (target < ticks) ||
+				(has_input && (input.move_dir != inputs[target].move_dir || input.fire != inputs[target].fire)))
+			{
+				fprintf(stderr, "Seed %u: seeking to tick %zu gave tick %u\n", seed, target, sim->game.tick);
+				++failures;
+			}
+		}
+		delete sim;
+		DestroyReplay(&replay);
+	}
+
+	// Truncated files, a broken index and chunks that do not fit are
+	// rejected, on loading or when the chunk is used
+	std::vector<Input> inputs;
+	std::vector<Game> states;
+	record_game(sprites, 5, 3 * REPLAY_KEYFRAME_INTERVAL, inputs, states);
+	std::vector<uint8_t> bytes = read_bytes();
+	ReplayFooter footer;
+	memcpy(&footer, bytes.data() + bytes.size() - sizeof(footer), sizeof(footer));
+
+	std::vector<uint8_t> truncated(bytes.begin() + 1, bytes.end());
+	std::vector<uint8_t> bad_index = bytes;
+	bad_index[footer.index_offset + 8] ^= 0x04;
+	std::vector<uint8_t> bad_ticks = bytes;
+	reinterpret_cast<ReplayFooter*>(bad_ticks.data() + bad_ticks.size() - sizeof(footer))->num_ticks += REPLAY_KEYFRAME_INTERVAL;
+	const std::vector<uint8_t>* invalid[] = { &truncated, &bad_index, &bad_ticks };
+	for (const std::vector<uint8_t>* file : invalid)
+	{
+		Replay replay;
+		if (write_bytes(*file) && LoadReplay(path, &replay))
+		{
+			fprintf(stderr, "An invalid replay of %zu bytes was loaded\n", file->size());
+			DestroyReplay(&replay);
+			++failures;
+		}
+	}
+
+	std::vector<uint8_t> bad_runs = bytes;
+	uint64_t second_chunk;
+	memcpy(&second_chunk, bytes.data() + footer.index_offset + 8, sizeof(second_chunk));
+	reinterpret_cast<ReplayChunk*>(bad_runs.data() + second_chunk)->num_runs = 4096;
+	Replay replay;
+	if (!write_bytes(bad_runs) || !LoadReplay(path, &replay))
+	{
+		fprintf(stderr, "Could not load a replay with a bad chunk\n");
+		++failures;
+	}
+	else
+	{
+		size_t first_mismatch;
+		replay_simulate(&replay, sprites, &first_mismatch);
+		if (replay_chunk(&replay, 1) || first_mismatch != REPLAY_KEYFRAME_INTERVAL)
+		{
+			fprintf(stderr, "A chunk past its end was used, mismatch at %zu\n", first_mismatch);
+			++failures;
+		}
+		DestroyReplay(&replay);
+	}
+
+	// A keyframe whose state could not be stepped safely is never restored:
+	// seeking past it fails and the re-simulation stops there
+	const char* corruptions[] = { "60000 aliens", "64 aliens", "a NaN offset", "a fire in the future", "negative lives" };
+	for (size_t c = 0; c < sizeof(corruptions) / sizeof(corruptions[0]); ++c)
+	{
+		std::vector<uint8_t> bad_state = bytes;
+		Game& state = reinterpret_cast<ReplayChunk*>(bad_state.data() + second_chunk)->state;
+		if (c == 0) state.aliens.count = 60000;
+		else if (c == 1) state.aliens.count = 64;
+		else if (c == 2) state.xi = std::nanf("");
+		else if (c == 3) state.last_fire_tick = state.tick + 1;
+		else state.player.life = -1;
+		if (!write_bytes(bad_state) || !LoadReplay(path, &replay))
+		{
+			fprintf(stderr, "Could not load a replay with a keyframe of %s\n", corruptions[c]);
+			++failures;
+			continue;
+		}
+
+		Simulation* sim = new Simulation(sprites, 5);
+		Input input;
+		ReplayCursor at = replay_seek(&replay, sim, REPLAY_KEYFRAME_INTERVAL + 10);
+		size_t first_mismatch;
+		replay_simulate(&replay, sprites, &first_mismatch);
+		if (replay_chunk(&replay, 1) || sim->game.tick != 0 || replay_next(&at, &input) || first_mismatch != REPLAY_KEYFRAME_INTERVAL)
+		{
+			fprintf(stderr, "A keyframe of %s was used, mismatch at %zu\n", corruptions[c], first_mismatch);
+			++failures;
+		}
+		delete sim;
+		DestroyReplay(&replay);
+	}
+
+	remove(path);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "../src/Rewind.h"
+
+// Plays bot games while recording them for rewinding, then steps back
+// through them and checks every state against the one the game was in
+static Input bot_input(size_t t, uint32_t seed)
+{
+	Input input;
+	input.move_dir = static_cast<int>(((t / (SIMULATION_TICK_RATE * 3 / 10)) * 7 + seed) % 3) - 1;
+	input.fire = (t % (SIMULATION_TICK_RATE / 3) == 0);
+	return input;
+}
+
+// Steps sim through ticks more ticks, keeping the state before each in states
+static void play(Simulation* sim, RewindBuffer* rewind, uint32_t seed, size_t ticks, std::vector<Game>& states)
+{
+	for (size_t t = 0; t < ticks; ++t)
+	{
+		Input input = bot_input(sim->game.tick, seed);
+		states.resize(sim->game.tick + 1);
+		states[sim->game.tick] = sim->game;
+		rewind_record(rewind, *sim, input);
+		sim->step(input);
+	}
+	states.resize(sim->game.tick + 1);
+	states[sim->game.tick] = sim->game;
+}
+
+// Steps back count ticks, or to the oldest state kept when count is
+// SIZE_MAX, comparing each state. Returns the number of failures
+static int step_back(Simulation* sim, RewindBuffer* rewind, size_t count, const std::vector<Game>& states, const char* name)
+{
+	for (size_t n = 0; n < count; ++n)
+	{
+		size_t tick = sim->game.tick;
+		if (!rewind_step_back(rewind, sim))
+		{
+			if (count == SIZE_MAX) return 0;
+			fprintf(stderr, "%s: could not step back from tick %zu\n", name, tick);
+			return 1;
+		}
+
+		if (sim->game.tick + 1 != tick || memcmp(&sim->game, &states[sim->game.tick], sizeof(Game)) != 0)
+		{
+			fprintf(stderr, "%s: stepping back from tick %zu gave a different state at tick %u\n", name, tick, sim->game.tick);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	int failures = 0;
+
+	// The whole of a game that ends before its last tick, back to the start
+	{
+		Simulation* sim = new Simulation(sprites, 1);
+		RewindBuffer* rewind = CreateRewindBuffer(1 << 20);
+		std::vector<Game> states;
+		play(sim, rewind, 1, 20000, states);
+		if (rewind_ticks(rewind) != 20000) fprintf(stderr, "Whole game: %zu ticks kept\n", rewind_ticks(rewind)), ++failures;
+		failures += step_back(sim, rewind, SIZE_MAX, states, "Whole game");
+		if (sim->game.tick != 0 || rewind_ticks(rewind) != 0) fprintf(stderr, "Whole game: rewound to tick %u\n", sim->game.tick), ++failures;
+		DestroyRewindBuffer(rewind);
+		delete sim;
+	}
+
+	// A buffer too small for the game keeps its end, the records wrapping
+	// around many times
+	{
+		Simulation* sim = new Simulation(sprites, 2);
+		RewindBuffer* rewind = CreateRewindBuffer(16 << 10);
+		std::vector<Game> states;
+		play(sim, rewind, 2, 20000, states);
+		size_t kept = rewind_ticks(rewind);
+		if (kept >= 20000 || kept < 1000) fprintf(stderr, "Small buffer: %zu ticks kept\n", kept), ++failures;
+		failures += step_back(sim, rewind, SIZE_MAX, states, "Small buffer");
+		if (sim->game.tick != 20000 - kept) fprintf(stderr, "Small buffer: rewound to tick %u of %zu\n", sim->game.tick, 20000 - kept), ++failures;
+		DestroyRewindBuffer(rewind);
+		delete sim;
+	}
+
+	// Rewinding part way, in and across intervals, then playing on with
+	// other inputs replaces what followed
+	{
+		Simulation* sim = new Simulation(sprites, 3);
+		RewindBuffer* rewind = CreateRewindBuffer(1 << 20);
+		std::vector<Game> states;
+		play(sim, rewind, 3, 1000, states);
+		failures += step_back(sim, rewind, 3, states, "Branch");
+		failures += step_back(sim, rewind, 2 * REWIND_INTERVAL + 1, states, "Branch");
+		play(sim, rewind, 4, 700, states);
+		failures += step_back(sim, rewind, 5, states, "Branch");
+		play(sim, rewind, 5, 300, states);
+		failures += step_back(sim, rewind, SIZE_MAX, states, "Branch");
+		if (sim->game.tick != 0) fprintf(stderr, "Branch: rewound to tick %u\n", sim->game.tick), ++failures;
+		DestroyRewindBuffer(rewind);
+		delete sim;
+	}
+
+	return failures ? 1 : 0;
+}
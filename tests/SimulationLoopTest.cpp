@@ -0,0 +1,125 @@
+#include <cstdio>
+#include "../src/SimulationLoop.h"
+
+// Checks the clock hands out ticks at SIMULATION_TICK_RATE, then runs the
+// simulation thread's loop against a GL thread that stops taking frames
+// for a while: the game must keep stepping on schedule meanwhile, and the
+// frames taken right afterwards must show the ticks played in between
+// Ticks due and taken are the same however unevenly the clock is read
+static int check_schedule()
+{
+	int failures = 0;
+	TickClock clock = CreateTickClock(10.0);
+	size_t taken = 0;
+	double now = 10.0;
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		now += 0.0001 * (i % 97);
+		taken += tick_clock_take(&clock, now);
+		double wait = tick_clock_wait(clock);
+		if (wait < 0 || wait > SIMULATION_DT || tick_clock_alpha(clock) < 0 || tick_clock_alpha(clock) > 1)
+		{
+			fprintf(stderr, "At %f: %f s to the next tick, alpha %f\n", now, wait, tick_clock_alpha(clock));
+			++failures;
+			break;
+		}
+	}
+	size_t due = static_cast<size_t>((now - 10.0) * SIMULATION_TICK_RATE);
+	if (taken + 1 < due || taken > due)
+	{
+		fprintf(stderr, "Took %zu ticks in %f s, %zu were due\n", taken, now - 10.0, due);
+		++failures;
+	}
+
+	// A stall of the reading thread itself is only caught up to a limit
+	size_t after_stall = tick_clock_take(&clock, now + 10.0);
+	size_t limit = static_cast<size_t>(TICK_CLOCK_MAX_CATCH_UP * SIMULATION_TICK_RATE);
+	if (after_stall + 1 < limit || after_stall > limit)
+	{
+		fprintf(stderr, "Took %zu ticks after a 10 s stall, expected %zu\n", after_stall, limit);
+		++failures;
+	}
+	return failures;
+}
+
+// The simulation thread's loop on simulated time, against a GL thread
+// that takes every frame, then none for half a second, as when stuck in a
+// swap or while the window is dragged, then every frame again
+static int check_blocked_consumer()
+{
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	Simulation* sim = new Simulation(sprites, 1);
+	TripleBuffer* frames = CreateTripleBuffer(16, 16);
+	Controls controls;
+	controls.move_dir = 1;
+	controls.fire_pressed = false;
+	controls.rewind_held = false;
+	SimulationLoop loop = CreateSimulationLoop(sim, frames, &controls, 0.0);
+
+	const double blocked_from = 0.5, blocked_until = 1.0, draw_time = 0.003;
+	double now = 0;
+	uint64_t sequence = 0;
+	uint32_t tick_before = 0, tick_after = 0;
+	size_t frames_taken_after = 0, passes_blocked = 0;
+	int failures = 0;
+	while (now < 1.5 && !failures)
+	{
+		bool draw = simulation_loop_pass(&loop, now);
+
+		// Every tick due is stepped, whatever the GL thread does
+		double due = now * SIMULATION_TICK_RATE;
+		if (sim->game.tick + 1 < due || sim->game.tick > due)
+		{
+			fprintf(stderr, "At %f s the game was at tick %u, %f were due\n", now, sim->game.tick, due);
+			++failures;
+		}
+
+		if (draw)
+		{
+			Frame* frame = triple_buffer_back(frames);
+			frame->buffer.data[0] = sim->game.tick;
+			frame->sequence = ++sequence;
+			triple_buffer_publish(frames);
+			now += draw_time;
+		}
+		else
+		{
+			if (now >= blocked_from && now < blocked_until) ++passes_blocked;
+			// A real sleep always lasts a little longer than asked
+			now += tick_clock_wait(loop.clock) + 1e-6;
+		}
+
+		if (now < blocked_from || now >= blocked_until)
+		{
+			const Frame* frame = triple_buffer_acquire(frames);
+			if (frame && now < blocked_from) tick_before = frame->buffer.data[0];
+			else if (frame && frames_taken_after++ < 2) tick_after = frame->buffer.data[0];
+		}
+	}
+
+	// While blocked the loop only waited for ticks, a pass per tick
+	size_t ticks_blocked = static_cast<size_t>((blocked_until - blocked_from) * SIMULATION_TICK_RATE);
+	if (passes_blocked + 2 < ticks_blocked || passes_blocked > ticks_blocked + 2)
+	{
+		fprintf(stderr, "%zu passes while blocked for %zu ticks\n", passes_blocked, ticks_blocked);
+		++failures;
+	}
+
+	// The frame waiting since before the block comes first, the one drawn
+	// right after it shows everything played meanwhile
+	if (tick_after < tick_before + ticks_blocked)
+	{
+		fprintf(stderr, "Blocked for %zu ticks, the frames went from tick %u to %u\n", ticks_blocked, tick_before, tick_after);
+		++failures;
+	}
+
+	DestroyTripleBuffer(frames);
+	delete sim;
+	return failures;
+}
+
+int main() {
+	int failures = check_schedule();
+	failures += check_blocked_consumer();
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "../src/Simulation.h"
+
+// Plays a few hundred games with the headless bot, checking the game state
+// stays consistent, that the same seed plays the same games, and that
+// games stepped in turn or on separate threads play as they do alone
+struct BotResult
+{
+	size_t games;
+	size_t total_score;
+};
+
+// Input of the games compared across threads
+static Input test_input(size_t t)
+{
+	return Input{ static_cast<int>(t / 90 % 3) - 1, t % 20 == 0 };
+}
+
+static bool check_state(const Simulation& sim)
+{
+	const Game& game = sim.game;
+	if (popcount64(game.aliens.alive) != static_cast<unsigned>(game.total_aliens))
+	{
+		fprintf(stderr, "tick %u: %d aliens left but %u alive bits\n",
+			game.tick, game.total_aliens, popcount64(game.aliens.alive));
+		return false;
+	}
+	if (game.score % 10 != 0 || game.player.life > 3 || game.bullets.count > GAME_MAX_BULLETS)
+	{
+		fprintf(stderr, "tick %u: score %u, %d lives, %u bullets\n",
+			game.tick, game.score, game.player.life, game.bullets.count);
+		return false;
+	}
+	for (size_t bi = 0; bi < game.bullets.count; ++bi)
+	{
+		if (game.bullets.y[bi] < 0 || game.bullets.y[bi] >= ptrdiff_t(game.height))
+		{
+			fprintf(stderr, "tick %u: bullet %zu left the screen\n", game.tick, bi);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool run_bot(const GameSprites& sprites, size_t ticks, BotResult* result)
+{
+	Simulation* sim = new Simulation(sprites, 1);
+	Random bot = CreateRandom(1);
+	Input input = { 0, false };
+	result->games = 1;
+	result->total_score = 0;
+
+	for (size_t t = 0; t < ticks; ++t)
+	{
+		if (t % (SIMULATION_TICK_RATE / 2) == 0) input.move_dir = static_cast<int>(random_below(bot, 3)) - 1;
+		input.fire = (t % (SIMULATION_TICK_RATE / 4) == 0);
+
+		sim->step(input);
+		if (!check_state(*sim))
+		{
+			delete sim;
+			return false;
+		}
+
+		if (sim->game.gameOver)
+		{
+			result->total_score += sim->game.score;
+			delete sim;
+			sim = new Simulation(sprites, static_cast<uint32_t>(result->games + 1));
+			++result->games;
+		}
+	}
+
+	result->total_score += sim->game.score;
+	delete sim;
+	return true;
+}
+
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+
+	BotResult first, second;
+	if (!run_bot(sprites, 200000, &first) || !run_bot(sprites, 200000, &second)) return 1;
+
+	if (first.games != second.games || first.total_score != second.total_score)
+	{
+		fprintf(stderr, "Same seed gave %zu games / %zu points, then %zu games / %zu points\n",
+			first.games, first.total_score, second.games, second.total_score);
+		return 1;
+	}
+	if (first.games < 2 || first.total_score == 0)
+	{
+		fprintf(stderr, "The bot played %zu games and scored %zu\n", first.games, first.total_score);
+		return 1;
+	}
+
+	// Each game draws from its own generator, so stepping several in turn,
+	// or at once on their own threads, changes nothing
+	const size_t ticks = 5000, num_games = 4;
+	Simulation* alone[num_games];
+	Simulation* in_turn[num_games];
+	Simulation* threaded[num_games];
+	for (size_t g = 0; g < num_games; ++g)
+	{
+		alone[g] = new Simulation(sprites, 7 + g);
+		in_turn[g] = new Simulation(sprites, 7 + g);
+		threaded[g] = new Simulation(sprites, 7 + g);
+		for (size_t t = 0; t < ticks; ++t) alone[g]->step(test_input(t));
+	}
+	for (size_t t = 0; t < ticks; ++t)
+	{
+		for (size_t g = 0; g < num_games; ++g) in_turn[g]->step(test_input(t));
+	}
+	std::thread threads[num_games];
+	for (size_t g = 0; g < num_games; ++g)
+	{
+		Simulation* sim = threaded[g];
+		threads[g] = std::thread([sim, ticks]()
+		{
+			for (size_t t = 0; t < ticks; ++t) sim->step(test_input(t));
+		});
+	}
+	for (size_t g = 0; g < num_games; ++g) threads[g].join();
+
+	int failures = 0;
+	for (size_t g = 0; g < num_games; ++g)
+	{
+		if (memcmp(&alone[g]->game, &in_turn[g]->game, sizeof(Game)) != 0)
+		{
+			fprintf(stderr, "Game %zu played differently when stepped in turn with others\n", g);
+			++failures;
+		}
+		if (memcmp(&alone[g]->game, &threaded[g]->game, sizeof(Game)) != 0)
+		{
+			fprintf(stderr, "Game %zu played differently when stepped on its own thread\n", g);
+			++failures;
+		}
+		delete alone[g];
+		delete in_turn[g];
+		delete threaded[g];
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "../src/Render.h"
+#include "../src/SpriteAtlas.h"
+
+// What shaders/Sprite.shader does for one instance: every pixel whose
+// center is inside the quad reads the atlas texel its interpolated
+// coordinate falls in, and takes the color where that texel is opaque
+static void draw_instance(Buffer* buffer, const SpriteAtlas& atlas, const SpriteInstance& instance)
+{
+	for (ptrdiff_t py = std::max<ptrdiff_t>(instance.y, 0); py < std::min<ptrdiff_t>(instance.y + instance.height, buffer->height); ++py)
+	{
+		for (ptrdiff_t px = std::max<ptrdiff_t>(instance.x, 0); px < std::min<ptrdiff_t>(instance.x + instance.width, buffer->width); ++px)
+		{
+			double cx = (px - instance.x + 0.5) / instance.width;
+			double cy = (py - instance.y + 0.5) / instance.height;
+			size_t u = static_cast<size_t>(std::floor(instance.atlas_x + cx * instance.atlas_width));
+			size_t v = static_cast<size_t>(std::floor(instance.atlas_y + (1.0 - cy) * instance.atlas_height));
+			if (atlas.pixels[v * atlas.width + u]) buffer->data[py * buffer->width + px] = instance.color;
+		}
+	}
+}
+
+// Random frames drawn straight into a buffer, and recorded, turned into
+// instances and drawn the way the GPU renderer draws them
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	const GlyphAtlas& glyphs = BUILTIN_GLYPHS;
+	SpriteAtlas atlas = CreateSpriteAtlas(sprites, glyphs);
+	const Sprite* candidates[] = {
+		&sprites.alien_sprites[0], &sprites.alien_sprites[5], &sprites.alien_death_sprite,
+		&sprites.player_sprite, &sprites.bullet_sprite, &glyphs.life_sprite,
+		&glyphs.glyphs['S'], &glyphs.glyphs['7']
+	};
+	const size_t num_candidates = sizeof(candidates) / sizeof(candidates[0]);
+
+	for (const Sprite* sprite : candidates)
+	{
+		if (!sprite_atlas_find(atlas, sprite))
+		{
+			fprintf(stderr, "A game sprite is missing from the atlas\n");
+			return 1;
+		}
+	}
+
+	const size_t width = 224, height = 256;
+	Buffer reference;
+	reference.width = width;
+	reference.height = height;
+	reference.data = new uint32_t[width * height];
+	reference.dirty = NULL;
+	reference.draws = NULL;
+
+	Buffer recorded = reference;
+	recorded.data = NULL;
+	recorded.draws = new DrawList;
+
+	Buffer gpu = reference;
+	gpu.data = new uint32_t[width * height];
+
+	SpriteInstance* instances = new SpriteInstance[DRAW_LIST_MAX];
+	srand(1);
+	int failures = 0;
+	for (int frame = 0; frame < 50 && failures < 10; ++frame)
+	{
+		draw_list_clear(recorded.draws);
+		Buffer* buffers[] = { &reference, &recorded };
+		uint32_t clear_color = rand();
+		for (Buffer* buffer : buffers) buffer_clear(buffer, clear_color);
+
+		for (int draw = 0; draw < 300; ++draw)
+		{
+			size_t x = rand() % (width + 40) - 20;
+			size_t y = rand() % (height + 40) - 20;
+			uint32_t color = rand();
+			if (draw % 10 == 0)
+			{
+				size_t w = rand() % 40, h = rand() % 40;
+				for (Buffer* buffer : buffers) buffer_fill_rect(buffer, x, y, w, h, color);
+			}
+			else
+			{
+				const Sprite& sprite = *candidates[rand() % num_candidates];
+				for (Buffer* buffer : buffers) buffer_draw_sprite(buffer, sprite, x, y, color);
+			}
+		}
+
+		size_t count = sprite_atlas_instances(atlas, recorded.draws, instances);
+		if (count != recorded.draws->count)
+		{
+			fprintf(stderr, "Frame %d: %zu instances for %zu draws\n", frame, count, recorded.draws->count);
+			return 1;
+		}
+		for (size_t i = 0; i < count; ++i) draw_instance(&gpu, atlas, instances[i]);
+
+		for (size_t i = 0; i < width * height && failures < 10; ++i)
+		{
+			if (gpu.data[i] != reference.data[i])
+			{
+				fprintf(stderr, "Frame %d: pixel (%zu, %zu) is %08x, expected %08x\n",
+					frame, i % width, i / width, gpu.data[i], reference.data[i]);
+				++failures;
+			}
+		}
+	}
+
+	delete[] instances;
+	delete[] gpu.data;
+	delete recorded.draws;
+	delete[] reference.data;
+	DestroySpriteAtlas(atlas);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <vector>
+#include "../src/SpriteBlob.h"
+
+static bool same_sprite(const Sprite& a, const Sprite& b)
+{
+	if (!a.rows || !b.rows) return !a.rows && !b.rows;
+	if (a.width != b.width || a.height != b.height) return false;
+	for (size_t yi = 0; yi < a.height; ++yi)
+	{
+		if (a.rows[yi] != b.rows[yi]) return false;
+	}
+	return true;
+}
+
+static bool write_bytes(const char* path, const std::vector<uint8_t>& bytes)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file) return false;
+	fwrite(bytes.data(), 1, bytes.size(), file);
+	return fclose(file) == 0;
+}
+
+// A blob written from the built in sprites loads back the same sprites,
+// and damaged files are rejected
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	const GlyphAtlas& glyphs = BUILTIN_GLYPHS;
+	const char* path = "SpriteBlobTest.blob";
+	int failures = 0;
+
+	if (!write_sprite_blob(path, sprites, glyphs))
+	{
+		fprintf(stderr, "Could not write %s\n", path);
+		return 1;
+	}
+
+	SpriteBlob blob;
+	if (!LoadSpriteBlob(path, &blob))
+	{
+		fprintf(stderr, "Could not load %s\n", path);
+		return 1;
+	}
+	GameSprites loaded = sprite_blob_game_sprites(&blob);
+	GlyphAtlas loaded_glyphs = sprite_blob_glyphs(&blob);
+	for (size_t i = 0; i < 6; ++i)
+	{
+		if (!same_sprite(loaded.alien_sprites[i], sprites.alien_sprites[i])) fprintf(stderr, "Alien %zu differs\n", i), ++failures;
+	}
+	if (!same_sprite(loaded.alien_death_sprite, sprites.alien_death_sprite)) fprintf(stderr, "Death sprite differs\n"), ++failures;
+	if (!same_sprite(loaded.player_sprite, sprites.player_sprite)) fprintf(stderr, "Player differs\n"), ++failures;
+	if (!same_sprite(loaded.bullet_sprite, sprites.bullet_sprite)) fprintf(stderr, "Bullet differs\n"), ++failures;
+	if (!same_sprite(loaded_glyphs.life_sprite, glyphs.life_sprite)) fprintf(stderr, "Life sprite differs\n"), ++failures;
+	for (size_t i = 0; i < GLYPH_ATLAS_SIZE; ++i)
+	{
+		if (!same_sprite(loaded_glyphs.glyphs[i], glyphs.glyphs[i])) fprintf(stderr, "Glyph %zu differs\n", i), ++failures;
+	}
+
+	std::vector<uint8_t> bytes(blob.bytes, blob.bytes + blob.size);
+	DestroySpriteBlob(&blob);
+
+	// Cut short, with a foreign magic, and with a sprite reaching past the rows
+	std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 4);
+	std::vector<uint8_t> bad_magic = bytes;
+	bad_magic[0] ^= 0xFF;
+	std::vector<uint8_t> bad_row = bytes;
+	SpriteBlobEntry* first_entry = reinterpret_cast<SpriteBlobEntry*>(bad_row.data() + sizeof(SpriteBlobHeader));
+	first_entry->first_row = reinterpret_cast<const SpriteBlobHeader*>(bad_row.data())->num_rows;
+	const std::vector<uint8_t>* damaged[] = { &truncated, &bad_magic, &bad_row };
+	for (const std::vector<uint8_t>* file : damaged)
+	{
+		if (!write_bytes(path, *file)) return 1;
+		if (LoadSpriteBlob(path, &blob))
+		{
+			fprintf(stderr, "Loaded a damaged blob of %zu bytes\n", file->size());
+			DestroySpriteBlob(&blob);
+			++failures;
+		}
+	}
+
+	remove(path);
+	return failures ? 1 : 0;
+}
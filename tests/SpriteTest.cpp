@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <cstdlib>
+#include "../src/Sprites.h"
+
+// sprite_overlap_check against comparing every opaque pixel of both sprites
+static bool pixel_at(const Sprite& sprite, ptrdiff_t sx, ptrdiff_t sy, ptrdiff_t x, ptrdiff_t y)
+{
+	ptrdiff_t xi = x - sx;
+	ptrdiff_t yi = sy + static_cast<ptrdiff_t>(sprite.height) - 1 - y;
+	if (xi < 0 || yi < 0 || xi >= ptrdiff_t(sprite.width) || yi >= ptrdiff_t(sprite.height)) return false;
+	return (sprite.rows[yi] >> xi) & 1;
+}
+
+// The tables are packed by the compiler, so the packing is checked there
+static_assert(sprite_rows<3, 2>("@.@" ".@.").rows[0] == 0x5, "Bit i of a row is column i");
+static_assert(sprite_rows<3, 2>("@.@" ".@.").rows[1] == 0x2, "Row 0 is the top one");
+
+static bool reference_overlap(const Sprite& a, ptrdiff_t xa, ptrdiff_t ya, const Sprite& b, ptrdiff_t xb, ptrdiff_t yb)
+{
+	for (ptrdiff_t y = ya; y < ya + ptrdiff_t(a.height); ++y)
+	{
+		for (ptrdiff_t x = xa; x < xa + ptrdiff_t(a.width); ++x)
+		{
+			if (pixel_at(a, xa, ya, x, y) && pixel_at(b, xb, yb, x, y)) return true;
+		}
+	}
+	return false;
+}
+
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	const Sprite* candidates[] = {
+		&sprites.alien_sprites[0], &sprites.alien_sprites[3], &sprites.alien_sprites[4],
+		&sprites.alien_death_sprite, &sprites.player_sprite, &sprites.bullet_sprite
+	};
+	const size_t num_candidates = sizeof(candidates) / sizeof(candidates[0]);
+	srand(1);
+
+	size_t hits = 0;
+	for (int iteration = 0; iteration < 200000; ++iteration)
+	{
+		const Sprite& a = *candidates[rand() % num_candidates];
+		const Sprite& b = *candidates[rand() % num_candidates];
+		ptrdiff_t xa = rand() % 40, ya = rand() % 40;
+		ptrdiff_t xb = rand() % 40, yb = rand() % 40;
+
+		bool expected = reference_overlap(a, xa, ya, b, xb, yb);
+		bool got = sprite_overlap_check(a, xa, ya, b, xb, yb);
+		if (got != expected)
+		{
+			fprintf(stderr, "sprite_overlap_check(%zux%zu at %td,%td, %zux%zu at %td,%td) = %d\n",
+				a.width, a.height, xa, ya, b.width, b.height, xb, yb, got);
+			return 1;
+		}
+		hits += got;
+	}
+
+	// A bullet inside the rectangle of an alien but on a transparent
+	// corner must miss
+	const Sprite& alien = sprites.alien_sprites[0];
+	if (sprite_overlap_check(sprites.bullet_sprite, 0, alien.height - 3, alien, 0, 0))
+	{
+		fprintf(stderr, "Bullet hit the transparent corner of an alien\n");
+		return 1;
+	}
+
+	return hits ? 0 : 1;
+}
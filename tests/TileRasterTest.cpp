@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <cstdlib>
+#include "../src/Render.h"
+#include "../src/TileRaster.h"
+
+// Random frames of fills and sprites, some hanging off every edge, drawn
+// once straight into a buffer and once recorded and drawn by the tiled
+// rasterizer at several scales. Every target pixel must be the buffer
+// pixel it scales up
+int main() {
+	const GameSprites& sprites = BUILTIN_SPRITES;
+	const GlyphAtlas& glyphs = BUILTIN_GLYPHS;
+	const Sprite* candidates[] = {
+		&sprites.alien_sprites[0], &sprites.alien_sprites[3], &sprites.alien_sprites[4],
+		&sprites.alien_death_sprite, &sprites.player_sprite, &sprites.bullet_sprite,
+		&glyphs.life_sprite, &glyphs.glyphs['S']
+	};
+	const size_t num_candidates = sizeof(candidates) / sizeof(candidates[0]);
+	const size_t width = 224, height = 256;
+
+	Buffer reference;
+	reference.width = width;
+	reference.height = height;
+	reference.data = new uint32_t[width * height];
+	reference.dirty = NULL;
+	reference.draws = NULL;
+
+	Buffer recorded = reference;
+	recorded.data = NULL;
+	recorded.draws = new DrawList;
+
+	ThreadPool* pool = CreateThreadPool(4);
+	srand(1);
+	int failures = 0;
+	const size_t scales[] = { 1, 3, 4, 8 };
+	for (size_t scale : scales)
+	{
+		TileRasterizer* rasterizer = CreateTileRasterizer(width, height, scale, pool);
+		uint32_t* target = new uint32_t[width * scale * height * scale];
+
+		for (int frame = 0; frame < 20 && failures < 10; ++frame)
+		{
+			draw_list_clear(recorded.draws);
+			Buffer* buffers[] = { &reference, &recorded };
+			uint32_t clear_color = rand();
+			for (Buffer* buffer : buffers) buffer_clear(buffer, clear_color);
+
+			for (int draw = 0; draw < 300; ++draw)
+			{
+				size_t x = rand() % (width + 40) - 20;
+				size_t y = rand() % (height + 40) - 20;
+				uint32_t color = rand();
+				if (draw % 10 == 0)
+				{
+					size_t w = rand() % 40, h = rand() % 40;
+					for (Buffer* buffer : buffers) buffer_fill_rect(buffer, x, y, w, h, color);
+				}
+				else
+				{
+					const Sprite& sprite = *candidates[rand() % num_candidates];
+					for (Buffer* buffer : buffers) buffer_draw_sprite(buffer, sprite, x, y, color);
+				}
+			}
+
+			tile_raster_draw(rasterizer, recorded.draws, target);
+			for (size_t ty = 0; ty < height * scale && failures < 10; ++ty)
+			{
+				for (size_t tx = 0; tx < width * scale && failures < 10; ++tx)
+				{
+					uint32_t expected = reference.data[(ty / scale) * width + tx / scale];
+					uint32_t got = target[ty * width * scale + tx];
+					if (got != expected)
+					{
+						fprintf(stderr, "Scale %zu frame %d: pixel (%zu, %zu) is %08x, expected %08x\n",
+							scale, frame, tx, ty, got, expected);
+						++failures;
+					}
+				}
+			}
+		}
+
+		delete[] target;
+		DestroyTileRasterizer(rasterizer);
+	}
+
+	DestroyThreadPool(pool);
+	delete recorded.draws;
+	delete[] reference.data;
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Trace.h"
+
+// Several threads record into the ring at once, more events than it
+// holds. The newest TRACE_RING_SIZE events must all survive, each thread's
+// events in order, and the JSON must hold exactly those
+int main() {
+	TraceRing* ring = CreateTraceRing();
+	const size_t num_threads = 4;
+	const size_t events_per_thread = TRACE_RING_SIZE;
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back([ring, events_per_thread]()
+		{
+			for (size_t i = 0; i < events_per_thread; ++i)
+			{
+				PhaseClock::time_point now = PhaseClock::now();
+				trace_complete(ring, "event", now, now);
+			}
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+
+	uint64_t total = ring->next.load();
+	if (total != num_threads * events_per_thread)
+	{
+		fprintf(stderr, "Recorded %llu events, expected %zu\n", (unsigned long long)total, num_threads * events_per_thread);
+		return 1;
+	}
+	for (uint64_t index = total - TRACE_RING_SIZE; index < total; ++index)
+	{
+		if (ring->events[index & (TRACE_RING_SIZE - 1)].sequence.load() != index + 1)
+		{
+			fprintf(stderr, "Event %llu was not published\n", (unsigned long long)index);
+			return 1;
+		}
+	}
+
+	trace_instant(ring, "instant");
+	const char* path = "TraceTest.json";
+	if (!trace_write_json(ring, path))
+	{
+		fprintf(stderr, "Could not write %s\n", path);
+		return 1;
+	}
+
+	FILE* file = fopen(path, "r");
+	std::string json;
+	char chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) json.append(chunk, read);
+	fclose(file);
+	remove(path);
+
+	size_t events = 0;
+	for (size_t at = json.find("\"ph\":"); at != std::string::npos; at = json.find("\"ph\":", at + 1)) ++events;
+	if (json.compare(0, 15, "{\"displayTimeUn") != 0 || events != TRACE_RING_SIZE ||
+		json.find("\"name\":\"instant\",\"ph\":\"i\"") == std::string::npos)
+	{
+		fprintf(stderr, "Unexpected trace JSON with %zu events\n", events);
+		return 1;
+	}
+
+	delete ring;
+	return 0;
+}
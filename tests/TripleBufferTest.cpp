@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <thread>
+#include "../src/TripleBuffer.h"
+
+// A producer fills every frame with its sequence number while a consumer
+// takes whatever is newest. The consumer must never see a frame torn by
+// the producer, nor an older frame after a newer one
+int main() {
+	const size_t width = 64, height = 64;
+	const uint64_t num_frames = 200000;
+	TripleBuffer* frames = CreateTripleBuffer(width, height);
+
+	std::thread producer([frames, num_frames]()
+	{
+		for (uint64_t sequence = 1; sequence <= num_frames; ++sequence)
+		{
+			Frame* frame = triple_buffer_back(frames);
+			for (size_t i = 0; i < width * height; ++i)
+			{
+				frame->buffer.data[i] = static_cast<uint32_t>(sequence);
+			}
+			frame->sequence = sequence;
+			triple_buffer_publish(frames);
+		}
+	});
+
+	uint64_t last = 0;
+	size_t taken = 0;
+	bool failed = false;
+	while (last < num_frames && !failed)
+	{
+		const Frame* frame = triple_buffer_acquire(frames);
+		if (!frame) continue;
+		++taken;
+
+		if (frame->sequence <= last)
+		{
+			fprintf(stderr, "Took frame %llu after frame %llu\n", (unsigned long long)frame->sequence, (unsigned long long)last);
+			failed = true;
+		}
+		for (size_t i = 0; i < width * height && !failed; ++i)
+		{
+			if (frame->buffer.data[i] != static_cast<uint32_t>(frame->sequence))
+			{
+				fprintf(stderr, "Frame %llu has pixel %zu from frame %u\n", (unsigned long long)frame->sequence, i, frame->buffer.data[i]);
+				failed = true;
+			}
+		}
+		last = frame->sequence;
+	}
+	producer.join();
+
+	if (!failed && triple_buffer_acquire(frames))
+	{
+		fprintf(stderr, "Took a frame after the last one\n");
+		failed = true;
+	}
+
+	DestroyTripleBuffer(frames);
+	if (failed) return 1;
+	printf("Took %zu of %llu frames\n", taken, (unsigned long long)num_frames);
+	return 0;
+}
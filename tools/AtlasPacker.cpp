@@ -0,0 +1,19 @@
+#include <cstdio>
+#include "../src/SpriteBlob.h"
+
+// Packs the sprites built into Sprites.cpp into the blob the game loads
+// at startup. Usage: atlaspacker OUTPUT
+int main(int argc, char** argv) {
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: %s OUTPUT\n", argv[0]);
+		return 2;
+	}
+
+	if (!write_sprite_blob(argv[1], BUILTIN_SPRITES, BUILTIN_GLYPHS))
+	{
+		fprintf(stderr, "Error writing %s\n", argv[1]);
+		return 1;
+	}
+	return 0;
+}